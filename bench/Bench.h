@@ -0,0 +1,72 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_BENCH_H
+#define ASSIMP2VF_BENCH_H
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/* Returns the fastest of the given number of runs in seconds. */
+template<typename F>
+double Measure (F f, unsigned int runs = 5) {
+    double best = 0;
+    for (auto i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now ();
+        f ();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+        if (i == 0 || elapsed.count () < best) best = elapsed.count ();
+    }
+    return best;
+}
+
+inline void Report (const std::string &name, double seconds, double items, const char *unit) {
+    std::cout << std::left << std::setw (48) << name << std::right
+              << std::setw (10) << std::fixed << std::setprecision (3) << seconds * 1000.0 << " ms"
+              << std::setw (12) << std::setprecision (2) << items / seconds / 1.0e6 << " M" << unit << "/s" << std::endl;
+}
+
+/* Swallows what the converter reports on standard error while it exists. */
+class SilenceErrors {
+public:
+    SilenceErrors (void) : buffer (std::cerr.rdbuf (sink.rdbuf ())) {
+    }
+    ~SilenceErrors (void) {
+        std::cerr.rdbuf (buffer);
+    }
+private:
+    std::ostringstream sink;
+    std::streambuf *buffer;
+};
+
+void WeldBench (void);
+void MiniballBench (void);
+void SubmeshSortBench (void);
+void VFSaveBench (const std::string &outputdir);
+void AnimationBench (const std::string &outputdir);
+/* throws if a reduction does not reproduce the dropped keys within tolerance */
+void KeyframeBench (void);
+void IOBench (const std::string &outputdir);
+/* enables the Profiler, so it has to run last */
+void AttributeBench (void);
+
+#endif /* !defined ASSIMP2VF_BENCH_H */
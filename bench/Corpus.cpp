@@ -0,0 +1,304 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Corpus.h"
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/* Height field over an n x n grid, with normals and texture coordinates. */
+struct Grid {
+    Grid (unsigned int n_, float phase) : n (n_) {
+        for (auto y = 0; y <= n; y++) {
+            for (auto x = 0; x <= n; x++) {
+                heights.push_back (Height (x, y, phase));
+                float dx = Height (x + 1, y, phase) - Height (x - 1, y, phase);
+                float dy = Height (x, y + 1, phase) - Height (x, y - 1, phase);
+                float length = std::sqrt (dx * dx + 4.0f + dy * dy);
+                normals.push_back (-dx / length);
+                normals.push_back (2.0f / length);
+                normals.push_back (-dy / length);
+            }
+        }
+    }
+    static float Height (int x, int y, float phase) {
+        return 4.0f * std::sin (0.11f * x + phase) * std::cos (0.07f * y) + 0.5f * std::sin (0.9f * (x + y));
+    }
+    unsigned int Index (unsigned int x, unsigned int y) const {
+        return y * (n + 1) + x;
+    }
+    unsigned int n;
+    std::vector<float> heights;
+    std::vector<float> normals;
+};
+
+std::ofstream Create (const std::string &path) {
+    std::ofstream file (path);
+    if (!file) {
+        throw std::runtime_error ("cannot write \"" + path + "\"");
+    }
+    file << std::fixed << std::setprecision (6);
+    return file;
+}
+
+void Close (std::ofstream &file, const std::string &path) {
+    file.close ();
+    if (!file) {
+        throw std::runtime_error ("cannot write \"" + path + "\"");
+    }
+}
+
+/*
+ * A terrain split into several objects (one node each), whose rows use
+ * the materials in bands of eight.
+ */
+CorpusFile WriteObj (const std::string &directory, const std::string &stem, unsigned int n, unsigned int objects,
+                     unsigned int materials) {
+    const Grid grid (n, 0.0f);
+    {
+        const std::string path (directory + stem + ".mtl");
+        std::ofstream mtl (Create (path));
+        for (auto i = 0; i < materials; i++) {
+            mtl << "newmtl material" << i << std::endl;
+            mtl << "Kd " << 0.2f + 0.1f * i << " 0.5 " << 0.8f - 0.1f * i << std::endl << std::endl;
+        }
+        Close (mtl, path);
+    }
+
+    const std::string path (directory + stem + ".obj");
+    std::ofstream obj (Create (path));
+    obj << "mtllib " << stem << ".mtl" << std::endl;
+    for (auto y = 0; y <= n; y++) {
+        for (auto x = 0; x <= n; x++) {
+            obj << "v " << float (x) << " " << grid.heights[grid.Index (x, y)] << " " << float (y) << std::endl;
+        }
+    }
+    for (auto y = 0; y <= n; y++) {
+        for (auto x = 0; x <= n; x++) {
+            obj << "vt " << float (x) / n << " " << float (y) / n << std::endl;
+        }
+    }
+    for (auto i = 0; i < grid.normals.size (); i += 3) {
+        obj << "vn " << grid.normals[i] << " " << grid.normals[i + 1] << " " << grid.normals[i + 2] << std::endl;
+    }
+    for (auto object = 0; object < objects; object++) {
+        obj << "o part" << object << std::endl;
+        int material = -1;
+        for (auto y = object * n / objects; y < (object + 1) * n / objects; y++) {
+            if (material != (y / 8) % materials) {
+                material = (y / 8) % materials;
+                obj << "usemtl material" << material << std::endl;
+            }
+            for (auto x = 0; x < n; x++) {
+                /* OBJ indices start at 1 */
+                unsigned int a = grid.Index (x, y) + 1, b = a + 1, c = grid.Index (x, y + 1) + 1, d = c + 1;
+                obj << "f " << a << "/" << a << "/" << a << " " << c << "/" << c << "/" << c << " "
+                    << d << "/" << d << "/" << d << std::endl;
+                obj << "f " << a << "/" << a << "/" << a << " " << d << "/" << d << "/" << d << " "
+                    << b << "/" << b << "/" << b << std::endl;
+            }
+        }
+    }
+    Close (obj, path);
+    return CorpusFile { stem + ".obj", 2ul * n * n };
+}
+
+void WriteColladaSource (std::ostream &os, const std::string &id, const std::vector<float> &values,
+                         const std::vector<std::string> &params) {
+    os << "        <source id=\"" << id << "\">" << std::endl;
+    os << "          <float_array id=\"" << id << "-array\" count=\"" << values.size () << "\">";
+    for (auto i = 0; i < values.size (); i++) {
+        os << (i ? " " : "") << values[i];
+    }
+    os << "</float_array>" << std::endl;
+    os << "          <technique_common>" << std::endl;
+    os << "            <accessor source=\"#" << id << "-array\" count=\"" << values.size () / params.size ()
+       << "\" stride=\"" << params.size () << "\">" << std::endl;
+    for (auto &param : params) {
+        os << "              <param name=\"" << param << "\" type=\"float\"/>" << std::endl;
+    }
+    os << "            </accessor>" << std::endl;
+    os << "          </technique_common>" << std::endl;
+    os << "        </source>" << std::endl;
+}
+
+/*
+ * A node hierarchy (all nodes below the first one) with one grid per node,
+ * whose halves use different materials, and one animation that moves
+ * every node along a circle.
+ */
+CorpusFile WriteCollada (const std::string &directory, const std::string &stem, unsigned int n, unsigned int nodes,
+                         unsigned int keys) {
+    const std::string path (directory + stem + ".dae");
+    std::ofstream dae (Create (path));
+    dae << "<?xml version=\"1.0\" encoding=\"utf-8\"?>" << std::endl;
+    dae << "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">" << std::endl;
+    dae << "  <asset>" << std::endl;
+    dae << "    <unit name=\"meter\" meter=\"1\"/>" << std::endl;
+    dae << "    <up_axis>Y_UP</up_axis>" << std::endl;
+    dae << "  </asset>" << std::endl;
+
+    const char *materials[] = { "Material-Rock", "grass" };
+    dae << "  <library_effects>" << std::endl;
+    for (auto i = 0; i < 2; i++) {
+        dae << "    <effect id=\"effect" << i << "\">" << std::endl;
+        dae << "      <profile_COMMON>" << std::endl;
+        dae << "        <technique sid=\"common\">" << std::endl;
+        dae << "          <lambert><diffuse><color>" << 0.3f + 0.4f * i << " 0.5 0.5 1</color></diffuse></lambert>"
+            << std::endl;
+        dae << "        </technique>" << std::endl;
+        dae << "      </profile_COMMON>" << std::endl;
+        dae << "    </effect>" << std::endl;
+    }
+    dae << "  </library_effects>" << std::endl;
+    dae << "  <library_materials>" << std::endl;
+    for (auto i = 0; i < 2; i++) {
+        dae << "    <material id=\"" << materials[i] << "\" name=\"" << materials[i] << "\">"
+            << "<instance_effect url=\"#effect" << i << "\"/></material>" << std::endl;
+    }
+    dae << "  </library_materials>" << std::endl;
+
+    dae << "  <library_geometries>" << std::endl;
+    for (auto node = 0; node < nodes; node++) {
+        const Grid grid (n, 0.5f * node);
+        std::vector<float> positions, texcoords;
+        for (auto y = 0; y <= n; y++) {
+            for (auto x = 0; x <= n; x++) {
+                positions.push_back (x);
+                positions.push_back (grid.heights[grid.Index (x, y)]);
+                positions.push_back (y);
+                texcoords.push_back (float (x) / n);
+                texcoords.push_back (float (y) / n);
+            }
+        }
+        std::stringstream id;
+        id << "geometry" << node;
+        dae << "    <geometry id=\"" << id.str () << "\" name=\"" << id.str () << "\">" << std::endl;
+        dae << "      <mesh>" << std::endl;
+        WriteColladaSource (dae, id.str () + "-positions", positions, { "X", "Y", "Z" });
+        WriteColladaSource (dae, id.str () + "-normals", grid.normals, { "X", "Y", "Z" });
+        WriteColladaSource (dae, id.str () + "-texcoords", texcoords, { "S", "T" });
+        dae << "        <vertices id=\"" << id.str () << "-vertices\">" << std::endl;
+        dae << "          <input semantic=\"POSITION\" source=\"#" << id.str () << "-positions\"/>" << std::endl;
+        dae << "        </vertices>" << std::endl;
+        for (auto half = 0; half < 2; half++) {
+            dae << "        <triangles material=\"symbol" << half << "\" count=\"" << n * n << "\">" << std::endl;
+            dae << "          <input semantic=\"VERTEX\" source=\"#" << id.str () << "-vertices\" offset=\"0\"/>"
+                << std::endl;
+            dae << "          <input semantic=\"NORMAL\" source=\"#" << id.str () << "-normals\" offset=\"0\"/>"
+                << std::endl;
+            dae << "          <input semantic=\"TEXCOORD\" source=\"#" << id.str ()
+                << "-texcoords\" offset=\"0\" set=\"0\"/>" << std::endl;
+            dae << "          <p>";
+            for (auto y = half * n / 2; y < (half + 1) * n / 2; y++) {
+                for (auto x = 0; x < n; x++) {
+                    unsigned int a = grid.Index (x, y), b = a + 1, c = grid.Index (x, y + 1), d = c + 1;
+                    dae << (x || y > half * n / 2 ? " " : "") << a << " " << c << " " << d << " " << a << " " << d
+                        << " " << b;
+                }
+            }
+            dae << "</p>" << std::endl;
+            dae << "        </triangles>" << std::endl;
+        }
+        dae << "      </mesh>" << std::endl;
+        dae << "    </geometry>" << std::endl;
+    }
+    dae << "  </library_geometries>" << std::endl;
+
+    dae << "  <library_animations>" << std::endl;
+    for (auto node = 0; node < nodes; node++) {
+        std::vector<float> times, translations;
+        for (auto key = 0; key < keys; key++) {
+            const float angle = 6.2831853f * key / keys + node;
+            times.push_back (key / 24.0f);
+            translations.push_back (n * (node % 4) + std::cos (angle));
+            translations.push_back (0.0f);
+            translations.push_back (n * (node / 4) + std::sin (angle));
+        }
+        std::stringstream id;
+        id << "animation" << node;
+        dae << "    <animation id=\"" << id.str () << "\">" << std::endl;
+        WriteColladaSource (dae, id.str () + "-input", times, { "TIME" });
+        WriteColladaSource (dae, id.str () + "-output", translations, { "X", "Y", "Z" });
+        dae << "        <source id=\"" << id.str () << "-interpolation\">" << std::endl;
+        dae << "          <Name_array id=\"" << id.str () << "-interpolation-array\" count=\"" << keys << "\">";
+        for (auto key = 0; key < keys; key++) {
+            dae << (key ? " " : "") << "LINEAR";
+        }
+        dae << "</Name_array>" << std::endl;
+        dae << "          <technique_common>" << std::endl;
+        dae << "            <accessor source=\"#" << id.str () << "-interpolation-array\" count=\"" << keys
+            << "\" stride=\"1\">" << std::endl;
+        dae << "              <param name=\"INTERPOLATION\" type=\"name\"/>" << std::endl;
+        dae << "            </accessor>" << std::endl;
+        dae << "          </technique_common>" << std::endl;
+        dae << "        </source>" << std::endl;
+        dae << "      <sampler id=\"" << id.str () << "-sampler\">" << std::endl;
+        dae << "        <input semantic=\"INPUT\" source=\"#" << id.str () << "-input\"/>" << std::endl;
+        dae << "        <input semantic=\"OUTPUT\" source=\"#" << id.str () << "-output\"/>" << std::endl;
+        dae << "        <input semantic=\"INTERPOLATION\" source=\"#" << id.str () << "-interpolation\"/>" << std::endl;
+        dae << "      </sampler>" << std::endl;
+        dae << "      <channel source=\"#" << id.str () << "-sampler\" target=\"node" << node << "/translate\"/>"
+            << std::endl;
+        dae << "    </animation>" << std::endl;
+    }
+    dae << "  </library_animations>" << std::endl;
+
+    dae << "  <library_visual_scenes>" << std::endl;
+    dae << "    <visual_scene id=\"scene\" name=\"scene\">" << std::endl;
+    for (auto node = 0; node < nodes; node++) {
+        dae << "      <node id=\"node" << node << "\" name=\"node" << node << "\" sid=\"node" << node << "\">"
+            << std::endl;
+        dae << "        <translate sid=\"translate\">" << n * (node % 4) << " 0 " << n * (node / 4) << "</translate>"
+            << std::endl;
+        dae << "        <instance_geometry url=\"#geometry" << node << "\">" << std::endl;
+        dae << "          <bind_material><technique_common>" << std::endl;
+        for (auto i = 0; i < 2; i++) {
+            dae << "            <instance_material symbol=\"symbol" << i << "\" target=\"#"
+                << materials[(node + i) % 2] << "\"/>" << std::endl;
+        }
+        dae << "          </technique_common></bind_material>" << std::endl;
+        dae << "        </instance_geometry>" << std::endl;
+        if (node == 0) continue;
+        dae << "      </node>" << std::endl;
+    }
+    dae << "      </node>" << std::endl;
+    dae << "    </visual_scene>" << std::endl;
+    dae << "  </library_visual_scenes>" << std::endl;
+    dae << "  <scene>" << std::endl;
+    dae << "    <instance_visual_scene url=\"#scene\"/>" << std::endl;
+    dae << "  </scene>" << std::endl;
+    dae << "</COLLADA>" << std::endl;
+    Close (dae, path);
+    return CorpusFile { stem + ".dae", 2ul * n * n * nodes };
+}
+
+}
+
+std::vector<CorpusFile> GenerateCorpus (const std::string &directory) {
+    std::vector<CorpusFile> corpus;
+    corpus.push_back (WriteObj (directory, "small", 32, 2, 2));
+    corpus.push_back (WriteObj (directory, "terrain", 256, 4, 3));
+    corpus.push_back (WriteCollada (directory, "animated", 64, 8, 96));
+    return corpus;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_CORPUS_H
+#define ASSIMP2VF_CORPUS_H
+
+#include <string>
+#include <vector>
+
+struct CorpusFile {
+    /* file name relative to the corpus directory */
+    std::string name;
+    unsigned long triangles;
+};
+
+/*
+ * Writes the fixed set of OBJ and COLLADA files the performance harness
+ * converts into directory, which has to exist, and returns the files to
+ * pass to assimp2vf. The files are the same on every run.
+ */
+std::vector<CorpusFile> GenerateCorpus (const std::string &directory);
+
+#endif /* !defined ASSIMP2VF_CORPUS_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "Bench.h"
+#include "MappedIO.h"
+
+namespace {
+
+/* Reads the whole file in pieces of chunk bytes, or at once if chunk is 0, as importers do. */
+size_t ReadFile (Assimp::IOSystem &io, const std::string &path, std::vector<char> &buffer, size_t chunk) {
+    Assimp::IOStream *stream = io.Open (path.c_str (), "rb");
+    if (!stream) {
+        throw std::runtime_error ("cannot open \"" + path + "\"");
+    }
+    const size_t size = stream->FileSize ();
+    buffer.resize (size);
+    size_t read = 0;
+    if (chunk == 0) {
+        read = stream->Read (buffer.data (), 1, size);
+    } else {
+        for (size_t n; (n = stream->Read (buffer.data () + read, 1, std::min (chunk, size - read))) > 0;) {
+            read += n;
+        }
+    }
+    io.Close (stream);
+    return read;
+}
+
+}
+
+void IOBench (const std::string &outputdir) {
+    const std::string path (outputdir + "assimp2vf_bench.bin");
+    for (auto megabytes : { 16u, 256u }) {
+        const size_t size = size_t (megabytes) << 20;
+        {
+            std::mt19937 rng (megabytes);
+            std::vector<uint32_t> data (size / 4);
+            for (auto &word : data) word = rng ();
+            std::unique_ptr<FILE, int (*) (FILE*)> file (std::fopen (path.c_str (), "wb"), std::fclose);
+            if (!file || std::fwrite (data.data (), 1, size, file.get ()) != size) {
+                throw std::runtime_error ("cannot write \"" + path + "\"");
+            }
+        }
+
+        Assimp::DefaultIOSystem defaultio;
+        MappedIOSystem mappedio;
+        std::vector<char> a, b;
+        for (auto chunk : { size_t (0), size_t (4096) }) {
+            double defaulttime = Measure ([&] () {
+                ReadFile (defaultio, path, a, chunk);
+            });
+            double mappedtime = Measure ([&] () {
+                ReadFile (mappedio, path, b, chunk);
+            });
+            if (a != b) {
+                throw std::runtime_error ("mapped IO read different data than the default IO system");
+            }
+
+            std::stringstream name;
+            name << "read " << megabytes << " MiB " << (chunk ? "in 4 KiB chunks" : "at once");
+            Report (name.str () + " (DefaultIOSystem)", defaulttime, size, "B");
+            Report (name.str () + " (MappedIOSystem)", mappedtime, size, "B");
+        }
+        std::remove (path.c_str ());
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "Bench.h"
+#include "Keyframes.h"
+
+namespace {
+
+float Error (const aiVectorKey &a, const aiVectorKey &b, const aiVectorKey &key) {
+    const float f = float ((key.mTime - a.mTime) / (b.mTime - a.mTime));
+    return (a.mValue + f * (b.mValue - a.mValue) - key.mValue).Length ();
+}
+
+float Error (const aiQuatKey &a, const aiQuatKey &b, const aiQuatKey &key) {
+    const float f = float ((key.mTime - a.mTime) / (b.mTime - a.mTime));
+    aiQuaternion value;
+    aiQuaternion::Interpolate (value, a.mValue, b.mValue, f);
+    return QuatAngle (value.Normalize (), key.mValue);
+}
+
+/*
+ * Throws unless interpolating between the kept keys reproduces every
+ * dropped key within tolerance.
+ */
+template<typename Key>
+void CheckReduction (const std::string &name, const std::vector<Key> &keys, const std::vector<uint32_t> &kept,
+                     float tolerance) {
+    if (kept.empty () || kept.front () != 0) {
+        throw std::runtime_error (name + ": first key dropped");
+    }
+    if (kept.size () == 1) {
+        for (auto &key : keys) {
+            if (Error (keys[0], keys[0], key) > tolerance) {
+                throw std::runtime_error (name + ": channel reduced to a single key is not constant");
+            }
+        }
+        return;
+    }
+    if (kept.back () != keys.size () - 1) {
+        throw std::runtime_error (name + ": last key dropped");
+    }
+    for (auto k = 1; k < kept.size (); k++) {
+        if (kept[k] - kept[k - 1] > 256) {
+            throw std::runtime_error (name + ": kept keys more than 256 keys apart");
+        }
+        const Key &a = keys[kept[k - 1]], &b = keys[kept[k]];
+        for (auto i = kept[k - 1] + 1; i < kept[k]; i++) {
+            if (Error (a, b, keys[i]) > tolerance) {
+                std::stringstream message;
+                message << name << ": dropped key " << i << " is not reproduced within " << tolerance;
+                throw std::runtime_error (message.str ());
+            }
+        }
+    }
+}
+
+/* nearly linear motion with a little noise and an occasional change of direction */
+std::vector<aiVectorKey> VectorChannel (unsigned int n, float noise) {
+    std::mt19937 rng (n);
+    std::uniform_real_distribution<float> uniform (-noise, noise);
+    std::vector<aiVectorKey> keys (n);
+    aiVector3D position, velocity (0.01f, 0.005f, 0.0f);
+    for (auto i = 0; i < n; i++) {
+        if (i % 4096 == 4095) velocity = aiVector3D (velocity.y, -velocity.x, velocity.z + 0.001f);
+        position = position + velocity;
+        keys[i].mTime = i;
+        keys[i].mValue = position + aiVector3D (uniform (rng), uniform (rng), uniform (rng));
+    }
+    return keys;
+}
+
+/* steady rotation about a fixed axis with a little noise */
+std::vector<aiQuatKey> QuatChannel (unsigned int n, float noise) {
+    std::mt19937 rng (n);
+    std::uniform_real_distribution<float> uniform (-noise, noise);
+    std::vector<aiQuatKey> keys (n);
+    for (auto i = 0; i < n; i++) {
+        const float angle = 0.5f * (0.002f * i + uniform (rng));
+        keys[i].mTime = i;
+        keys[i].mValue = aiQuaternion (std::cos (angle), 0.0f, std::sin (angle), 0.0f);
+    }
+    return keys;
+}
+
+}
+
+void KeyframeBench (void) {
+    for (auto n : { 1024u, 65536u }) {
+        for (auto noise : { 0.0f, 1e-4f, 1e-2f }) {
+            const float tolerance = 1e-3f;
+            const std::vector<aiVectorKey> vectorkeys (VectorChannel (n, noise));
+            const std::vector<aiQuatKey> quatkeys (QuatChannel (n, noise));
+            std::vector<uint32_t> vectorkept, quatkept;
+            double vectortime = Measure ([&] () {
+                vectorkept = ReduceVectorKeys (vectorkeys.data (), n, tolerance);
+            });
+            double quattime = Measure ([&] () {
+                quatkept = ReduceQuatKeys (quatkeys.data (), n, tolerance);
+            });
+
+            std::stringstream name;
+            name << "keyframes " << n << " keys, noise " << noise;
+            CheckReduction (name.str () + " (vector)", vectorkeys, vectorkept, tolerance);
+            CheckReduction (name.str () + " (quaternion)", quatkeys, quatkept, tolerance);
+            Report (name.str () + " (vector)", vectortime, n, "keys");
+            Report (name.str () + " (quaternion)", quattime, n, "keys");
+        }
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <miniball/Seb.h>
+#include <miniball/Seb_fixed.h>
+#include "Bench.h"
+
+namespace {
+
+/* n points, half of them on the surface of an ellipsoid and half inside a box. */
+std::vector<double> PointCloud (unsigned int n) {
+    std::mt19937 rng (n);
+    std::uniform_real_distribution<double> uniform (-1.0, 1.0);
+    std::vector<double> points;
+    points.reserve (n * 3);
+    for (auto i = 0; i < n; i++) {
+        double p[3] = { uniform (rng), uniform (rng), uniform (rng) };
+        if (i % 2) {
+            double length = std::sqrt (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (length == 0) length = 1;
+            p[0] *= 3.0 / length;
+            p[1] *= 2.0 / length;
+            p[2] *= 1.0 / length;
+        }
+        points.insert (points.end (), p, p + 3);
+    }
+    return points;
+}
+
+}
+
+void MiniballBench (void) {
+    for (auto n : { 64u, 4096u, 262144u }) {
+        const std::vector<double> points (PointCloud (n));
+        double generic[4], fixed[4];
+
+        double generictime = Measure ([&] () {
+            std::vector<Seb::Point<double>> sebpoints;
+            sebpoints.reserve (n);
+            for (auto i = 0; i < points.size (); i += 3) {
+                sebpoints.emplace_back (3, &points[i]);
+            }
+            Seb::Smallest_enclosing_ball<double> miniball (3, sebpoints);
+            for (auto i = 0; i < 3; i++) generic[i] = *(miniball.center_begin () + i);
+            generic[3] = miniball.radius ();
+        });
+        double fixedtime = Measure ([&] () {
+            Seb::Strided_point_accessor<double> accessor (points.data (), n, 3);
+            Seb::Fixed_smallest_enclosing_ball<double, 3> miniball (accessor);
+            for (auto i = 0; i < 3; i++) fixed[i] = *(miniball.center_begin () + i);
+            fixed[3] = miniball.radius ();
+        });
+        for (auto i = 0; i < 4; i++) {
+            if (std::abs (generic[i] - fixed[i]) > 1e-9 * generic[3]) {
+                throw std::runtime_error ("fixed dimension miniball disagrees with the generic one");
+            }
+        }
+
+        std::stringstream name;
+        name << "miniball " << n << " points";
+        Report (name.str () + " (generic)", generictime, n, "points");
+        Report (name.str () + " (fixed)", fixedtime, n, "points");
+    }
+}
@@ -0,0 +1,438 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Corpus.h"
+#include "Hash.h"
+
+namespace {
+
+/* exit status that makes CTest report the test as skipped */
+const int SKIPPED = 77;
+
+/*
+ * Options of the reference run every case is repeated with: one worker
+ * thread and Assimp's own file reading have to give the same outputs.
+ */
+const char *const reference[] = { "-j", "1", "--no-mmap" };
+
+struct Measurement {
+    Measurement (void) : milliseconds (0), trianglespersecond (0), peakrss (0), hash (0) {
+    }
+    double milliseconds;
+    double trianglespersecond;
+    /* kilobytes */
+    long peakrss;
+    uint64_t hash;
+};
+
+struct Action {
+    const char *name;
+    /* command line flag, nullptr to convert */
+    const char *flag;
+};
+
+const Action actions[] = {
+    { "convert", nullptr },
+    { "outputs", "-l" },
+    { "materials", "-m" },
+    { "nodes", "-n" },
+    { "animations", "-a" }
+};
+
+void MakeDirectory (const std::string &path) {
+    if (mkdir (path.c_str (), 0777) != 0 && errno != EEXIST) {
+        throw std::runtime_error ("cannot create directory \"" + path + "\"");
+    }
+}
+
+/* sorted names of the regular files in a directory */
+std::vector<std::string> ListFiles (const std::string &directory) {
+    std::vector<std::string> files;
+    DIR *dir = opendir (directory.c_str ());
+    if (!dir) {
+        throw std::runtime_error ("cannot read directory \"" + directory + "\"");
+    }
+    while (struct dirent *entry = readdir (dir)) {
+        struct stat info;
+        if (stat ((directory + entry->d_name).c_str (), &info) == 0 && S_ISREG (info.st_mode)) {
+            files.push_back (entry->d_name);
+        }
+    }
+    closedir (dir);
+    std::sort (files.begin (), files.end ());
+    return files;
+}
+
+void HashFile (ContentHash &hash, const std::string &path) {
+    std::ifstream file (path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error ("cannot read \"" + path + "\"");
+    }
+    std::string content ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+    hash.Update (content);
+}
+
+/*
+ * Runs assimp2vf in directory with the given arguments, its standard
+ * output redirected to stdoutfile and standard error discarded. Returns
+ * the wall time in milliseconds and sets the peak resident set size.
+ */
+double Run (const std::string &assimp2vf, const std::string &directory, const std::vector<std::string> &args,
+            const std::string &stdoutfile, long &peakrss) {
+    std::vector<char*> argv;
+    argv.push_back (const_cast<char*> (assimp2vf.c_str ()));
+    for (auto &arg : args) argv.push_back (const_cast<char*> (arg.c_str ()));
+    argv.push_back (nullptr);
+
+    auto start = std::chrono::steady_clock::now ();
+    pid_t pid = fork ();
+    if (pid < 0) {
+        throw std::runtime_error ("cannot start " + assimp2vf);
+    }
+    if (pid == 0) {
+        int out = open (stdoutfile.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        int null = open ("/dev/null", O_WRONLY);
+        if (out < 0 || null < 0 || dup2 (out, 1) < 0 || dup2 (null, 2) < 0 || chdir (directory.c_str ()) != 0) {
+            _exit (127);
+        }
+        execv (assimp2vf.c_str (), argv.data ());
+        _exit (127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4 (pid, &status, 0, &usage) != pid) {
+        throw std::runtime_error ("cannot wait for " + assimp2vf);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now () - start;
+    if (!WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+        std::stringstream command;
+        for (auto &arg : args) command << " " << arg;
+        throw std::runtime_error ("assimp2vf" + command.str () + " failed in " + directory);
+    }
+    /* kilobytes on Linux */
+    peakrss = usage.ru_maxrss;
+    return elapsed.count ();
+}
+
+/*
+ * Best wall time and lowest peak memory of several runs; the outputs have
+ * to be the same for every run.
+ */
+Measurement Measure (const std::string &assimp2vf, const std::string &workdir, const CorpusFile &file,
+                     const Action &action, const std::vector<std::string> &options, unsigned int runs) {
+    Measurement measurement;
+    const std::string stem (file.name.substr (0, file.name.find_last_of ('.')));
+    const std::string outputdir (workdir + "out/" + stem + "/");
+    const std::string stdoutfile (workdir + stem + "." + action.name + ".txt");
+    std::vector<std::string> args (options);
+    if (action.flag) {
+        args.push_back (action.flag);
+    } else {
+        MakeDirectory (workdir + "out/");
+        MakeDirectory (outputdir);
+        args.push_back ("-o");
+        args.push_back ("out/" + stem);
+    }
+    args.push_back (file.name);
+
+    for (auto run = 0; run < runs; run++) {
+        if (!action.flag) {
+            for (auto &output : ListFiles (outputdir)) {
+                std::remove ((outputdir + output).c_str ());
+            }
+        }
+        long peakrss;
+        double milliseconds = Run (assimp2vf, workdir, args, stdoutfile, peakrss);
+
+        ContentHash hash;
+        HashFile (hash, stdoutfile);
+        if (!action.flag) {
+            for (auto &output : ListFiles (outputdir)) {
+                hash.Update (output);
+                HashFile (hash, outputdir + output);
+            }
+        }
+        if (run == 0 || milliseconds < measurement.milliseconds) measurement.milliseconds = milliseconds;
+        if (run == 0 || peakrss < measurement.peakrss) measurement.peakrss = peakrss;
+        if (run > 0 && hash.Get () != measurement.hash) {
+            throw std::runtime_error (file.name + " " + action.name + ": output differs between runs");
+        }
+        measurement.hash = hash.Get ();
+    }
+    measurement.trianglespersecond = file.triangles / (measurement.milliseconds * 1e-3);
+    return measurement;
+}
+
+/* lines of "case" followed by the values read by read, '#' starts a comment */
+template<typename Read>
+void LoadCases (const std::string &path, std::map<std::string, Measurement> &cases, Read read) {
+    std::ifstream file (path);
+    if (!file) {
+        throw std::runtime_error ("cannot read \"" + path + "\"");
+    }
+    std::string line;
+    while (std::getline (file, line)) {
+        if (line.empty () || line[0] == '#') continue;
+        std::istringstream stream (line);
+        std::string name;
+        stream >> name;
+        read (stream, cases[name]);
+        if (!stream) {
+            throw std::runtime_error ("invalid line in \"" + path + "\": " + line);
+        }
+    }
+}
+
+void SaveOutputs (const std::string &path, const std::vector<std::pair<std::string, Measurement>> &results) {
+    std::ofstream file (path);
+    file << "# assimp2vf output hashes of the generated corpus, written by assimp2vf_perf --update-outputs" << std::endl;
+    file << "# the outputs depend on the Assimp and OpenVF versions, record them again when those change" << std::endl;
+    file << "# case output-hash" << std::endl;
+    for (auto &result : results) {
+        file << result.first << " " << std::hex << std::setw (16) << std::setfill ('0') << result.second.hash
+             << std::dec << std::setfill (' ') << std::endl;
+    }
+    file.close ();
+    if (!file) {
+        throw std::runtime_error ("cannot write \"" + path + "\"");
+    }
+}
+
+void SaveTiming (const std::string &path, const std::vector<std::pair<std::string, Measurement>> &results) {
+    std::ofstream file (path);
+    file << "# assimp2vf timing baseline of this machine, written by assimp2vf_perf --update-timing" << std::endl;
+    file << "# case milliseconds triangles/s peak-rss-kb" << std::endl;
+    for (auto &result : results) {
+        const Measurement &m = result.second;
+        file << result.first << " " << std::fixed << std::setprecision (3) << m.milliseconds << " "
+             << std::setprecision (0) << m.trianglespersecond << " " << m.peakrss << std::endl;
+    }
+    file.close ();
+    if (!file) {
+        throw std::runtime_error ("cannot write \"" + path + "\"");
+    }
+}
+
+void Usage (const char *argv0) {
+    std::cerr << "Usage: " << argv0 << " [--runs=n] [--time-tolerance=f] [--memory-tolerance=f] [--update-outputs]"
+              << " [--update-timing] assimp2vf outputs timing workdir" << std::endl << std::endl
+              << "Converts a generated corpus of OBJ and COLLADA files with every action of assimp2vf. The outputs"
+              << std::endl << "have to match the hashes recorded in outputs and those of a run with -j 1 --no-mmap."
+              << std::endl << "Importing each file is also timed with --mmap and with --no-mmap for comparison."
+              << std::endl << "Wall time, triangles/s and peak memory are compared with the timing baseline; the"
+              << std::endl << "tolerances are the allowed relative regressions (defaults 0.25 and 0.10). Exits with"
+              << std::endl << "77 (skipped) if no hashes or no timing baseline have been recorded yet." << std::endl;
+}
+
+}
+
+int main (int argc, char *argv[]) {
+    try {
+        unsigned int runs = 5;
+        double timetolerance = 0.25, memorytolerance = 0.10;
+        bool updateoutputs = false, updatetiming = false;
+        std::vector<std::string> positional;
+        for (auto i = 1; i < argc; i++) {
+            std::string arg (argv[i]);
+            if (!arg.compare (0, 7, "--runs=")) {
+                runs = std::max (1, std::atoi (arg.c_str () + 7));
+            } else if (!arg.compare (0, 17, "--time-tolerance=")) {
+                timetolerance = std::atof (arg.c_str () + 17);
+            } else if (!arg.compare (0, 19, "--memory-tolerance=")) {
+                memorytolerance = std::atof (arg.c_str () + 19);
+            } else if (arg == "--update-outputs") {
+                updateoutputs = true;
+            } else if (arg == "--update-timing") {
+                updatetiming = true;
+            } else if (!arg.compare (0, 2, "--")) {
+                Usage (argv[0]);
+                return EXIT_FAILURE;
+            } else {
+                positional.push_back (arg);
+            }
+        }
+        if (positional.size () != 4) {
+            Usage (argv[0]);
+            return EXIT_FAILURE;
+        }
+        std::string assimp2vf (positional[0]), outputsfile (positional[1]), timingfile (positional[2]);
+        std::string workdir (positional[3]);
+        if (assimp2vf[0] != '/') {
+            char cwd[4096];
+            if (!getcwd (cwd, sizeof (cwd))) throw std::runtime_error ("cannot determine working directory");
+            assimp2vf = std::string (cwd) + "/" + assimp2vf;
+        }
+        if (workdir.back () != '/') workdir += '/';
+        MakeDirectory (workdir);
+
+        const std::vector<CorpusFile> corpus (GenerateCorpus (workdir));
+        const std::vector<std::string> referenceoptions (std::begin (reference), std::end (reference));
+        std::vector<std::pair<std::string, Measurement>> results;
+        unsigned int failures = 0;
+        for (auto &file : corpus) {
+            for (auto &action : actions) {
+                const std::string name (file.name + ":" + action.name);
+                results.emplace_back (name, Measure (assimp2vf, workdir, file, action, {}, runs));
+                if (Measure (assimp2vf, workdir, file, action, referenceoptions, 1).hash != results.back ().second.hash) {
+                    std::cout << name << ": output differs from the run with -j 1 --no-mmap" << std::endl;
+                    failures++;
+                }
+            }
+            /* listing the outputs imports the file without converting it: memory-mapped against read () */
+            const std::string name (file.name + ":import");
+            results.emplace_back (name + "-mmap", Measure (assimp2vf, workdir, file, actions[1], { "--mmap" }, runs));
+            results.emplace_back (name + "-no-mmap", Measure (assimp2vf, workdir, file, actions[1], { "--no-mmap" }, runs));
+            if (results[results.size () - 2].second.hash != results.back ().second.hash) {
+                std::cout << name << ": output differs between --mmap and --no-mmap" << std::endl;
+                failures++;
+            }
+        }
+
+        std::cout << std::left << std::setw (28) << "case" << std::right << std::setw (12) << "ms"
+                  << std::setw (14) << "Mtris/s" << std::setw (12) << "peak KiB" << std::endl;
+        for (auto &result : results) {
+            std::cout << std::left << std::setw (28) << result.first << std::right << std::fixed
+                      << std::setw (12) << std::setprecision (3) << result.second.milliseconds
+                      << std::setw (14) << std::setprecision (3) << result.second.trianglespersecond * 1e-6
+                      << std::setw (12) << result.second.peakrss << std::endl;
+        }
+        std::cout << std::endl << std::left << std::setw (28) << "import" << std::right << std::setw (12) << "mmap ms"
+                  << std::setw (14) << "no-mmap ms" << std::setw (12) << "mmap KiB" << std::setw (14) << "no-mmap KiB"
+                  << std::endl;
+        for (auto &file : corpus) {
+            auto find = [&] (const std::string &name) -> const Measurement & {
+                for (auto &result : results) {
+                    if (result.first == name) return result.second;
+                }
+                throw std::runtime_error ("no measurement for " + name);
+            };
+            const Measurement &mapped = find (file.name + ":import-mmap");
+            const Measurement &read = find (file.name + ":import-no-mmap");
+            std::cout << std::left << std::setw (28) << file.name << std::right << std::fixed
+                      << std::setw (12) << std::setprecision (3) << mapped.milliseconds
+                      << std::setw (14) << std::setprecision (3) << read.milliseconds
+                      << std::setw (12) << mapped.peakrss << std::setw (14) << read.peakrss << std::endl;
+        }
+        if (failures) {
+            std::cout << failures << " case(s) with outputs that depend on the options" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (updateoutputs) {
+            SaveOutputs (outputsfile, results);
+            std::cout << "output hashes written to " << outputsfile << std::endl;
+        }
+        if (updatetiming) {
+            SaveTiming (timingfile, results);
+            std::cout << "timing baseline written to " << timingfile << std::endl;
+        }
+        if (updateoutputs || updatetiming) {
+            return EXIT_SUCCESS;
+        }
+
+        /*
+         * Whatever was recorded is compared; a baseline that has not been recorded yet makes the test
+         * report itself as skipped instead of passing without having compared anything.
+         */
+        bool incomplete = false;
+        std::map<std::string, Measurement> outputs;
+        LoadCases (outputsfile, outputs, [] (std::istream &stream, Measurement &m) {
+            stream >> std::hex >> m.hash >> std::dec;
+        });
+        if (outputs.empty ()) {
+            std::cout << "no output hashes recorded in " << outputsfile << ", output comparison skipped;"
+                      << " record them with --update-outputs" << std::endl;
+            incomplete = true;
+        }
+        for (auto &result : results) {
+            if (outputs.empty ()) break;
+            auto it = outputs.find (result.first);
+            if (it == outputs.end ()) {
+                std::cout << result.first << ": no output hash recorded in " << outputsfile << std::endl;
+                failures++;
+            } else if (result.second.hash != it->second.hash) {
+                std::cout << result.first << ": output differs from the recorded hash" << std::endl;
+                failures++;
+            }
+        }
+
+        if (access (timingfile.c_str (), F_OK) != 0) {
+            std::cout << "no timing baseline at " << timingfile << ", timing comparison skipped;"
+                      << " record one with --update-timing" << std::endl;
+            incomplete = true;
+        } else {
+            std::map<std::string, Measurement> timing;
+            LoadCases (timingfile, timing, [] (std::istream &stream, Measurement &m) {
+                stream >> m.milliseconds >> m.trianglespersecond >> m.peakrss;
+            });
+            for (auto &result : results) {
+                auto it = timing.find (result.first);
+                if (it == timing.end ()) {
+                    std::cout << result.first << ": not in the timing baseline" << std::endl;
+                    failures++;
+                    continue;
+                }
+                const Measurement &m = result.second, &base = it->second;
+                if (m.milliseconds > base.milliseconds * (1.0 + timetolerance)) {
+                    std::cout << result.first << ": wall time regressed from " << base.milliseconds << " ms to "
+                              << m.milliseconds << " ms" << std::endl;
+                    failures++;
+                }
+                if (m.trianglespersecond * (1.0 + timetolerance) < base.trianglespersecond) {
+                    std::cout << result.first << ": throughput regressed from " << base.trianglespersecond * 1e-6
+                              << " to " << m.trianglespersecond * 1e-6 << " Mtris/s" << std::endl;
+                    failures++;
+                }
+                if (m.peakrss > base.peakrss * (1.0 + memorytolerance)) {
+                    std::cout << result.first << ": peak memory regressed from " << base.peakrss << " KiB to "
+                              << m.peakrss << " KiB" << std::endl;
+                    failures++;
+                }
+            }
+        }
+        if (failures) {
+            std::cout << failures << " regression(s)" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return incomplete ? SKIPPED : EXIT_SUCCESS;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+}
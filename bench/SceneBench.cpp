@@ -0,0 +1,195 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "Bench.h"
+#include "SceneGenerator.h"
+#include "Node.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+#include "VF.h"
+#include "Resample.h"
+#include "Profiler.h"
+
+namespace {
+
+SceneParameters Parameters (unsigned int nodes, unsigned int meshes, unsigned int gridsize, unsigned int uvchannels,
+                            unsigned int materials) {
+    SceneParameters parameters;
+    parameters.nodes = nodes;
+    parameters.meshes = meshes;
+    parameters.gridsize = gridsize;
+    parameters.uvchannels = uvchannels;
+    parameters.materials = materials;
+    return parameters;
+}
+
+std::string Describe (const SceneParameters &parameters) {
+    std::stringstream stream;
+    stream << parameters.nodes << "x" << parameters.meshes << " meshes of "
+           << 2 * parameters.gridsize * parameters.gridsize << " tris, " << parameters.uvchannels << " uv";
+    return stream.str ();
+}
+
+}
+
+void SubmeshSortBench (void) {
+    for (auto meshes : { 16u, 256u, 4096u }) {
+        std::shared_ptr<const aiScene> scene (GenerateScene (Parameters (1, meshes, 1, 0, meshes / 2)));
+        const aiNode *node = scene->mRootNode->mChildren[0];
+        std::vector<unsigned int> order;
+        const unsigned int runs = 65536 / meshes;
+
+        double time = Measure ([&] () {
+            for (auto i = 0; i < runs; i++) {
+                order = SubmeshOrder (scene.get (), node);
+            }
+        });
+        if (order.size () != meshes) {
+            throw std::runtime_error ("submesh order is not a permutation of the meshes");
+        }
+
+        std::stringstream name;
+        name << "submesh sort " << meshes << " submeshes";
+        Report (name.str (), time / runs, meshes, "submeshes");
+    }
+}
+
+void VFSaveBench (const std::string &outputdir) {
+    const std::string filename ("assimp2vf_bench.vf");
+    for (auto n : { 64u, 256u, 1024u }) {
+        const size_t numvertices = (n + 1) * (n + 1);
+        const size_t numindices = n * n * 6;
+        std::vector<float> positions (numvertices * 3), normals (numvertices * 3), texcoords (numvertices * 2);
+        for (auto i = 0; i < numvertices; i++) {
+            positions[i * 3 + 0] = i % (n + 1);
+            positions[i * 3 + 1] = i / (n + 1);
+            normals[i * 3 + 2] = 1.0f;
+            texcoords[i * 2 + 0] = float (i % (n + 1)) / n;
+            texcoords[i * 2 + 1] = float (i / (n + 1)) / n;
+        }
+        std::vector<uint32_t> indices (numindices);
+        for (auto i = 0; i < numindices; i++) {
+            indices[i] = (i * 7) % numvertices;
+        }
+        VF vf;
+        vf.AddSet ("POSITIONS", 3, VF_FLOAT, numvertices, positions.data ());
+        vf.AddSet ("NORMALS", 3, VF_FLOAT, numvertices, normals.data ());
+        vf.AddSet ("TEXCOORDS0", 2, VF_FLOAT, numvertices, texcoords.data ());
+        vf.AddSet ("INDICES", 1, VF_UNSIGNED_INT, numindices, indices.data ());
+        const size_t bytes = numvertices * 8 * sizeof (float) + numindices * sizeof (uint32_t);
+
+        Options options;
+        double time = Measure ([&] () {
+            SaveVF (vf, outputdir, filename, options, nullptr);
+        });
+        std::remove ((outputdir + filename).c_str ());
+
+        std::stringstream name;
+        name << "vfSave " << numvertices << " vertices";
+        Report (name.str (), time, bytes, "B");
+    }
+}
+
+void AnimationBench (const std::string &outputdir) {
+    for (auto keys : { 64u, 1024u }) {
+        SceneParameters parameters (Parameters (64, 1, 1, 0, 1));
+        parameters.channels = 64;
+        parameters.keys = keys;
+        std::shared_ptr<const aiScene> scene (GenerateScene (parameters));
+        const aiAnimation *anim = scene->mAnimations[0];
+        const double items = double (anim->mNumChannels) * keys;
+        std::vector<std::string> filenames;
+        for (auto i = 0; i < anim->mNumChannels; i++) {
+            std::stringstream filename;
+            filename << "assimp2vf_bench_" << i << ".vf";
+            filenames.push_back (filename.str ());
+        }
+
+        Options options;
+        double time = Measure ([&] () {
+            for (auto i = 0; i < anim->mNumChannels; i++) {
+                SaveNodeAnim (anim->mChannels[i], nullptr, anim->mTicksPerSecond, outputdir, filenames[i], options,
+                              nullptr);
+            }
+        });
+        options.keyframes = true;
+        double keyframetime = Measure ([&] () {
+            for (auto i = 0; i < anim->mNumChannels; i++) {
+                SaveNodeAnim (anim->mChannels[i], nullptr, anim->mTicksPerSecond, outputdir, filenames[i], options,
+                              nullptr);
+            }
+        });
+        double resampletime = Measure ([&] () {
+            ResampleAnimation (anim, 30.0);
+        });
+        for (auto &filename : filenames) {
+            std::remove ((outputdir + filename).c_str ());
+        }
+
+        std::stringstream name;
+        name << "animation " << anim->mNumChannels << " channels, " << keys << " keys";
+        Report (name.str () + " (SaveNodeAnim)", time, items, "keys");
+        Report (name.str () + " (--keyframes)", keyframetime, items, "keys");
+        Report (name.str () + " (resample)", resampletime, items, "keys");
+    }
+}
+
+void AttributeBench (void) {
+    const SceneParameters cases[] = {
+        Parameters (1, 1, 128, 0, 1),
+        Parameters (1, 1, 128, 1, 1),
+        Parameters (1, 1, 128, 4, 1),
+        Parameters (64, 4, 16, 1, 3),
+        Parameters (1, 64, 16, 2, 16)
+    };
+    const char *phases[] = { "welding", "attributes", "bounding spheres" };
+    const unsigned int runs = 5;
+    Profiler::get ().Enable ();
+    ThreadPool pool (1);
+    Options options;
+    options.indices = Options::INDICES_ADAPTIVE;
+
+    for (auto &parameters : cases) {
+        /* Scene::Load consumes its aiScene, so every run needs its own */
+        std::vector<std::shared_ptr<aiScene>> aiscenes;
+        for (auto i = 0; i < runs; i++) {
+            aiscenes.push_back (GenerateScene (parameters));
+        }
+        const double triangles = 2.0 * parameters.gridsize * parameters.gridsize * parameters.meshes * parameters.nodes;
+
+        Profiler::get ().Reset ();
+        unsigned int run = 0;
+        double time = Measure ([&] () {
+            SilenceErrors silence;
+            std::shared_ptr<Scene> scene (std::make_shared<Scene> (options));
+            scene->Load (aiscenes[run], pool);
+            aiscenes[run++].reset ();
+        }, runs);
+
+        const std::string name (Describe (parameters));
+        Report (name + " (Scene::Load)", time, triangles, "tris");
+        for (auto phase : phases) {
+            Report (name + " (" + phase + ")", Profiler::get ().GetSeconds (phase) / runs, triangles, "tris");
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SceneGenerator.h"
+#include <cmath>
+#include <random>
+#include <sstream>
+
+aiMesh *GridMesh (unsigned int n, unsigned int uvchannels, bool normals) {
+    aiMesh *mesh = new aiMesh;
+    mesh->mNumVertices = (n + 1) * (n + 1);
+    mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+    if (normals) {
+        mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+    }
+    for (auto j = 0; j < uvchannels; j++) {
+        mesh->mTextureCoords[j] = new aiVector3D[mesh->mNumVertices];
+        mesh->mNumUVComponents[j] = 2;
+    }
+    for (auto y = 0; y <= n; y++) {
+        for (auto x = 0; x <= n; x++) {
+            unsigned int index = y * (n + 1) + x;
+            mesh->mVertices[index] = aiVector3D (x, y, (x * y) % 7);
+            if (normals) {
+                mesh->mNormals[index] = aiVector3D (0, x % 2 ? -0.0f : 0.0f, 1);
+            }
+            for (auto j = 0; j < uvchannels; j++) {
+                mesh->mTextureCoords[j][index] = aiVector3D (float (x) / n + j, float (y) / n, 0);
+            }
+        }
+    }
+    mesh->mNumFaces = n * n * 2;
+    mesh->mFaces = new aiFace[mesh->mNumFaces];
+    for (auto y = 0; y < n; y++) {
+        for (auto x = 0; x < n; x++) {
+            unsigned int a = y * (n + 1) + x, b = a + 1, c = a + n + 1, d = c + 1;
+            aiFace *faces = &mesh->mFaces[(y * n + x) * 2];
+            faces[0].mNumIndices = faces[1].mNumIndices = 3;
+            faces[0].mIndices = new unsigned int[3] { a, b, d };
+            faces[1].mIndices = new unsigned int[3] { a, d, c };
+        }
+    }
+    return mesh;
+}
+
+namespace {
+
+std::string NodeName (unsigned int node) {
+    std::stringstream stream;
+    stream << "node" << node;
+    return stream.str ();
+}
+
+/* Translation along a circle, constant unit scaling and a rotation about y, as exported from most tools. */
+aiNodeAnim *GenerateChannel (const std::string &nodename, unsigned int keys, unsigned int seed) {
+    aiNodeAnim *channel = new aiNodeAnim;
+    channel->mNodeName.Set (nodename);
+    channel->mNumPositionKeys = channel->mNumScalingKeys = channel->mNumRotationKeys = keys;
+    channel->mPositionKeys = new aiVectorKey[keys];
+    channel->mScalingKeys = new aiVectorKey[keys];
+    channel->mRotationKeys = new aiQuatKey[keys];
+    for (auto i = 0; i < keys; i++) {
+        const float phase = 0.05f * i + seed;
+        channel->mPositionKeys[i].mTime = channel->mScalingKeys[i].mTime = channel->mRotationKeys[i].mTime = i;
+        channel->mPositionKeys[i].mValue = aiVector3D (std::cos (phase), std::sin (phase), 0.01f * i);
+        channel->mScalingKeys[i].mValue = aiVector3D (1, 1, 1);
+        channel->mRotationKeys[i].mValue = aiQuaternion (std::cos (0.5f * phase), 0, std::sin (0.5f * phase), 0);
+    }
+    return channel;
+}
+
+}
+
+std::shared_ptr<aiScene> GenerateScene (const SceneParameters &parameters) {
+    std::shared_ptr<aiScene> scene (new aiScene);
+    std::mt19937 rng (parameters.nodes * 7919 + parameters.meshes * 31 + parameters.materials);
+
+    scene->mNumMaterials = parameters.materials;
+    scene->mMaterials = new aiMaterial*[parameters.materials];
+    for (auto i = 0; i < parameters.materials; i++) {
+        std::stringstream stream;
+        if (i % 2) stream << "Material-";
+        for (auto j = 0; j < 8; j++) stream << char ((j % 2 ? 'a' : 'A') + rng () % 26);
+        stream << i;
+        aiString name (stream.str ());
+        scene->mMaterials[i] = new aiMaterial;
+        scene->mMaterials[i]->AddProperty (&name, AI_MATKEY_NAME);
+    }
+
+    scene->mNumMeshes = parameters.nodes * parameters.meshes;
+    scene->mMeshes = new aiMesh*[scene->mNumMeshes];
+    for (auto i = 0; i < scene->mNumMeshes; i++) {
+        aiMesh *mesh = GridMesh (parameters.gridsize, parameters.uvchannels, parameters.normals);
+        /* keep the submeshes of a node apart, so that no vertices are shared between them */
+        for (auto j = 0; j < mesh->mNumVertices; j++) {
+            mesh->mVertices[j].z += 8.0f * (i % parameters.meshes);
+        }
+        mesh->mMaterialIndex = rng () % parameters.materials;
+        scene->mMeshes[i] = mesh;
+    }
+
+    scene->mRootNode = new aiNode;
+    scene->mRootNode->mName.Set ("root");
+    scene->mRootNode->mNumChildren = parameters.nodes;
+    scene->mRootNode->mChildren = new aiNode*[parameters.nodes];
+    for (auto i = 0; i < parameters.nodes; i++) {
+        aiNode *node = new aiNode;
+        node->mName.Set (NodeName (i));
+        node->mParent = scene->mRootNode;
+        node->mNumMeshes = parameters.meshes;
+        node->mMeshes = new unsigned int[parameters.meshes];
+        for (auto j = 0; j < parameters.meshes; j++) {
+            node->mMeshes[j] = i * parameters.meshes + j;
+        }
+        scene->mRootNode->mChildren[i] = node;
+    }
+
+    if (parameters.channels > 0) {
+        aiAnimation *anim = new aiAnimation;
+        anim->mName.Set ("anim");
+        anim->mTicksPerSecond = 25.0;
+        anim->mDuration = parameters.keys > 0 ? parameters.keys - 1 : 0;
+        anim->mNumChannels = parameters.channels;
+        anim->mChannels = new aiNodeAnim*[parameters.channels];
+        for (auto i = 0; i < parameters.channels; i++) {
+            anim->mChannels[i] = GenerateChannel (NodeName (i % parameters.nodes), parameters.keys, i);
+        }
+        scene->mNumAnimations = 1;
+        scene->mAnimations = new aiAnimation*[1];
+        scene->mAnimations[0] = anim;
+    }
+    return scene;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_SCENEGENERATOR_H
+#define ASSIMP2VF_SCENEGENERATOR_H
+
+#include <assimp/scene.h>
+#include <memory>
+
+/*
+ * Shape of a procedural scene: a root node with the given number of mesh
+ * nodes below it, each referencing its own grid meshes.
+ */
+struct SceneParameters {
+    SceneParameters (void) : nodes (1), meshes (1), gridsize (32), uvchannels (1), normals (true), materials (1),
+                             channels (0), keys (0) {
+    }
+    unsigned int nodes;
+    /* submeshes per node */
+    unsigned int meshes;
+    /* every mesh is a gridsize x gridsize grid of 2 * gridsize * gridsize triangles */
+    unsigned int gridsize;
+    unsigned int uvchannels;
+    bool normals;
+    /* the meshes use the materials in turn, whose names are not in mesh order */
+    unsigned int materials;
+    /* channels of a single animation, each animating one of the nodes */
+    unsigned int channels;
+    /* keys per position, scaling and rotation track */
+    unsigned int keys;
+};
+
+/* Triangle corners of an n x n grid, i.e. each inner vertex is referenced six times. */
+aiMesh *GridMesh (unsigned int n, unsigned int uvchannels, bool normals = true);
+/* The same parameters always result in the same scene. */
+std::shared_ptr<aiScene> GenerateScene (const SceneParameters &parameters);
+
+#endif /* !defined ASSIMP2VF_SCENEGENERATOR_H */
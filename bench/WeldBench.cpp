@@ -0,0 +1,131 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include "Bench.h"
+#include "SceneGenerator.h"
+#include "Vertex.h"
+
+namespace {
+
+/* The vertex record and std::map based welding Node::Load used before VertexWelder. */
+struct LegacyVertex {
+    LegacyVertex (const aiVector3D &position, const aiVector3D &normal, const std::vector<aiVector3D> &texcoords) {
+        x = position.x;
+        y = position.y;
+        z = position.z;
+        nx = normal.x;
+        ny = normal.y;
+        nz = normal.z;
+        tx.reserve (texcoords.size ());
+        ty.reserve (texcoords.size ());
+        for (auto &texcoord : texcoords) {
+            tx.push_back (texcoord.x);
+            ty.push_back (texcoord.y);
+        }
+    }
+    bool operator< (const LegacyVertex &rhs) const {
+        const LegacyVertex &lhs = *this;
+        if (lhs.x < rhs.x) return true;
+        if (rhs.x < lhs.x) return false;
+        if (lhs.y < rhs.y) return true;
+        if (rhs.y < lhs.y) return false;
+        if (lhs.z < rhs.z) return true;
+        if (rhs.z < lhs.z) return false;
+        if (lhs.nx < rhs.nx) return true;
+        if (rhs.nx < lhs.nx) return false;
+        if (lhs.ny < rhs.ny) return true;
+        if (rhs.ny < lhs.ny) return false;
+        if (lhs.nz < rhs.nz) return true;
+        if (rhs.nz < lhs.nz) return false;
+        if (lhs.tx.size () < rhs.tx.size ()) return true;
+        if (rhs.tx.size () < lhs.tx.size ()) return false;
+        for (auto i = 0; i < lhs.tx.size (); i++) {
+            if (lhs.tx[i] < rhs.tx[i]) return true;
+            if (rhs.tx[i] < lhs.tx[i]) return false;
+            if (lhs.ty[i] < rhs.ty[i]) return true;
+            if (rhs.ty[i] < lhs.ty[i]) return false;
+        }
+        return false;
+    }
+    float x;
+    float y;
+    float z;
+    float nx;
+    float ny;
+    float nz;
+    std::vector<float> tx;
+    std::vector<float> ty;
+};
+
+}
+
+void WeldBench (void) {
+    for (auto n : { 128u, 512u, 1024u }) {
+        std::unique_ptr<aiMesh> mesh (GridMesh (n, 2));
+        const unsigned int uvchannels = mesh->GetNumUVChannels ();
+        const size_t numcorners = mesh->mNumFaces * 3;
+        std::vector<unsigned int> mapindices, welderindices;
+
+        double maptime = Measure ([&] () {
+            std::map<LegacyVertex, unsigned int> vertexmap;
+            std::vector<LegacyVertex> vertices;
+            mapindices.clear ();
+            for (auto faceid = 0; faceid < mesh->mNumFaces; faceid++) {
+                for (auto i = 0; i < 3; i++) {
+                    unsigned int index = mesh->mFaces[faceid].mIndices[i];
+                    std::vector<aiVector3D> texcoords;
+                    for (auto j = 0; j < uvchannels; j++) {
+                        texcoords.push_back (mesh->mTextureCoords[j][index]);
+                    }
+                    LegacyVertex v (mesh->mVertices[index], mesh->mNormals[index], texcoords);
+                    auto it = vertexmap.find (v);
+                    if (it == vertexmap.end ()) {
+                        index = vertices.size ();
+                        vertexmap[v] = index;
+                        vertices.push_back (v);
+                    } else {
+                        index = it->second;
+                    }
+                    mapindices.push_back (index);
+                }
+            }
+        });
+        double weldertime = Measure ([&] () {
+            VertexWelder<Vertex<2, true>> welder (numcorners / 4);
+            welderindices.clear ();
+            for (auto faceid = 0; faceid < mesh->mNumFaces; faceid++) {
+                for (auto i = 0; i < 3; i++) {
+                    welderindices.push_back (welder.Weld (Vertex<2, true> (mesh.get (), uvchannels, mesh->mFaces[faceid].mIndices[i])));
+                }
+            }
+        });
+        if (mapindices != welderindices) {
+            throw std::runtime_error ("VertexWelder disagrees with std::map welding");
+        }
+
+        std::stringstream name;
+        name << "weld " << numcorners << " corners";
+        Report (name.str () + " (std::map)", maptime, numcorners, "corners");
+        Report (name.str () + " (VertexWelder)", weldertime, numcorners, "corners");
+    }
+}
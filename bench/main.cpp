@@ -0,0 +1,47 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <string>
+#include "Bench.h"
+
+int main (int argc, char *argv[]) {
+    /* output files are written to and removed from the given directory */
+    std::string outputdir (argc > 1 ? argv[1] : "");
+    if (!outputdir.empty () && outputdir.back () != '/') outputdir += '/';
+    /* optionally only the benchmark of the given name runs */
+    const std::string only (argc > 2 ? argv[2] : "");
+    auto selected = [&] (const char *name) {
+        return only.empty () || only == name;
+    };
+    try {
+        if (selected ("weld")) WeldBench ();
+        if (selected ("miniball")) MiniballBench ();
+        if (selected ("submeshsort")) SubmeshSortBench ();
+        if (selected ("vfsave")) VFSaveBench (outputdir);
+        if (selected ("animation")) AnimationBench (outputdir);
+        if (selected ("keyframes")) KeyframeBench ();
+        if (selected ("io")) IOBench (outputdir);
+        if (selected ("attributes")) AttributeBench ();
+        return EXIT_SUCCESS;
+    } catch (const std::exception &e) {
+        std::cerr << "Exception: " << e.what () << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,320 @@
+// Synopsis: Smallest enclosing ball of points in compile-time dimension.
+//
+// Fixed dimension variant of Smallest_enclosing_ball (see Seb.h and
+// Seb-inl.h).  The algorithm is the same, step by step, but all
+// temporaries are fixed size arrays, the support set is a
+// Fixed_subspan, and the points are read from a flat strided array
+// through Strided_point_accessor, so computing a ball does not touch
+// the heap.  For Dim == 3 and SSE2 the farthest-point search in
+// init_ball() processes two points per step.
+
+#ifndef SEB_SEB_FIXED_H
+#define SEB_SEB_FIXED_H
+
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include "Seb_configure.h"
+#include "Subspan_fixed.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SEB_FIXED_SSE2
+#endif
+
+namespace SEB_NAMESPACE {
+
+  template<typename Float>
+  class Strided_point_accessor
+  // Presents count points stored in a flat array, the i-th point
+  // starting at data[i*stride], as a PointAccessor.  The array is not
+  // copied and must outlive the accessor.
+  {
+  public:
+    Strided_point_accessor(const Float *data, unsigned int count,
+                           unsigned int stride)
+    : data(data), count(count), stride(stride)
+    {}
+
+    const Float *operator[](unsigned int i) const
+    {
+      return data + std::size_t(i) * stride;
+    }
+
+    unsigned int size() const
+    {
+      return count;
+    }
+
+    unsigned int get_stride() const
+    {
+      return stride;
+    }
+
+  private:
+    const Float *data;
+    unsigned int count, stride;
+  };
+
+  template<typename Float, unsigned int Dim,
+           class PointAccessor = Strided_point_accessor<Float> >
+  class Fixed_smallest_enclosing_ball
+  // Same interface as Smallest_enclosing_ball, minus the dimension
+  // argument; the computation is done in the constructor.
+  {
+  public: // iterator-type to iterate over the center coordinates of
+          // the miniball (cf. center_begin() below):
+    typedef const Float *Coordinate_iterator;
+
+  public: // construction:
+
+    Fixed_smallest_enclosing_ball(const PointAccessor& P)
+    : S(P), support(P,0)
+    {
+      SEB_ASSERT(!is_empty());
+      update();
+    }
+
+  public: // access:
+
+    bool is_empty() const
+    {
+      return S.size() == 0;
+    }
+
+    Float squared_radius() const
+    {
+      return radius_square;
+    }
+
+    Float radius() const
+    {
+      return radius_;
+    }
+
+    Coordinate_iterator center_begin() const
+    {
+      return center;
+    }
+
+    Coordinate_iterator center_end() const
+    {
+      return center+Dim;
+    }
+
+  private: // we forbid copying (support refers to S):
+    Fixed_smallest_enclosing_ball(const Fixed_smallest_enclosing_ball&);
+    Fixed_smallest_enclosing_ball& operator=(const Fixed_smallest_enclosing_ball&);
+
+  private: // private helper routines, cf. Seb-inl.h:
+
+    unsigned int find_farthest()
+    // Sets radius_square to the squared distance from center to the
+    // point of S farthest from it and returns that point's index; of
+    // several farthest points the one with the largest index is chosen,
+    // as in Smallest_enclosing_ball::init_ball().
+    {
+      radius_square = 0;
+      unsigned int farthest = 0;
+      for (unsigned int j = 1; j < S.size(); ++j) {
+        Float dist = 0;
+        for (unsigned int i = 0; i < Dim; ++i)
+          dist += sqr(S[j][i] - center[i]);
+        if (dist >= radius_square) {
+          radius_square = dist;
+          farthest = j;
+        }
+      }
+      return farthest;
+    }
+
+    void init_ball()
+    {
+      for (unsigned int i = 0; i < Dim; ++i)
+        center[i] = S[0][i];
+
+      const unsigned int farthest = find_farthest();
+      radius_ = sqrt(radius_square);
+
+      support.reset(farthest);
+    }
+
+    bool successful_drop()
+    {
+      support.find_affine_coefficients(center,lambdas);
+
+      unsigned int smallest = 0;
+      Float minimum(1);
+      for (unsigned int i=0; i<support.size(); ++i)
+        if (lambdas[i] < minimum) {
+          minimum = lambdas[i];
+          smallest = i;
+        }
+
+      if (minimum <= 0) {
+        support.remove_point(smallest);
+        return true;
+      }
+      return false;
+    }
+
+    Float find_stop_fraction(int& stopper)
+    {
+      using std::inner_product;
+
+      Float scale =  1;
+      stopper     = -1;
+
+      for (unsigned int j = 0; j < S.size(); ++j)
+        if (!support.is_member(j)) {
+          for (unsigned int i = 0; i < Dim; ++i)
+            center_to_point[i] = S[j][i] - center[i];
+
+          const Float dir_point_prod
+          = inner_product(center_to_aff,center_to_aff+Dim,
+                          center_to_point,Float(0));
+
+          if (dist_to_aff_square - dir_point_prod
+              < Eps() * radius_ * dist_to_aff)
+            continue;
+
+          Float bound = radius_square;
+          bound -= inner_product(center_to_point,center_to_point+Dim,
+                                 center_to_point,Float(0));
+          bound /= 2 * (dist_to_aff_square - dir_point_prod);
+
+          if (bound > 0 && bound < scale) {
+            scale   = bound;
+            stopper = j;
+          }
+        }
+
+      return scale;
+    }
+
+    void update_radius()
+    {
+      const unsigned int member = support.any_member();
+      radius_square = 0;
+      for (unsigned int i = 0; i < Dim; ++i)
+        radius_square += sqr(S[member][i] - center[i]);
+      radius_ = sqrt(radius_square);
+    }
+
+    void update()
+    // The main loop, cf. Smallest_enclosing_ball::update().
+    {
+      init_ball();
+
+      while (true) {
+        while ((dist_to_aff
+                = sqrt(dist_to_aff_square
+                       = support.shortest_vector_to_span(center,
+                                                         center_to_aff)))
+               <= Eps() * radius_)
+          if (!successful_drop())
+            return;
+
+        int stopper;
+        Float scale = find_stop_fraction(stopper);
+
+        if (stopper >= 0 && support.size() <= Dim) {
+          for (unsigned int i = 0; i < Dim; ++i)
+            center[i] += scale * center_to_aff[i];
+          update_radius();
+          support.add_point(stopper);
+        }
+        else {
+          for (unsigned int i=0; i<Dim; ++i)
+            center[i] += center_to_aff[i];
+          update_radius();
+          if (!successful_drop())
+            return;
+        }
+      }
+    }
+
+    static Float Eps()
+    {
+      return Float(1e-14);
+    }
+
+  private: // member fields:
+    const PointAccessor &S;                  // set of points
+    Fixed_subspan<Float, Dim, PointAccessor> support; // current support
+    Float center[Dim];                       // center of current ball
+    Float radius_, radius_square;            // radius of current ball
+    Float center_to_aff[Dim];
+    Float center_to_point[Dim];
+    Float dist_to_aff, dist_to_aff_square;
+    Float lambdas[Dim+1];
+  };
+
+#ifdef SEB_FIXED_SSE2
+  template<>
+  inline unsigned int
+  Fixed_smallest_enclosing_ball<double, 3, Strided_point_accessor<double> >::
+  find_farthest()
+  // SSE2 version of the farthest-point search for the case that occurs
+  // in practice: two points per iteration, one per vector lane.  The
+  // running maximum is tracked per lane with the scalar tie rule
+  // (dist >= max), and the lanes are merged preferring the larger index,
+  // so the result is exactly the one of the scalar loop.
+  {
+    const unsigned int n = S.size();
+    const unsigned int stride = S.get_stride();
+    const double *p = S[0];
+
+    const __m128d cx = _mm_set1_pd(center[0]);
+    const __m128d cy = _mm_set1_pd(center[1]);
+    const __m128d cz = _mm_set1_pd(center[2]);
+    __m128d best = _mm_setzero_pd();
+    __m128d bestidx = _mm_set_pd(0, 0);
+    __m128d idx = _mm_set_pd(2, 1);
+    const __m128d two = _mm_set1_pd(2);
+
+    unsigned int j = 1;
+    for (; j + 1 < n; j += 2) {
+      const double *a = p + std::size_t(j) * stride;
+      const double *b = a + stride;
+      __m128d dx = _mm_sub_pd(_mm_set_pd(b[0], a[0]), cx);
+      __m128d dy = _mm_sub_pd(_mm_set_pd(b[1], a[1]), cy);
+      __m128d dz = _mm_sub_pd(_mm_set_pd(b[2], a[2]), cz);
+      __m128d dist = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                                           _mm_mul_pd(dy, dy)),
+                                _mm_mul_pd(dz, dz));
+      __m128d mask = _mm_cmpge_pd(dist, best);
+      best = _mm_or_pd(_mm_and_pd(mask, dist), _mm_andnot_pd(mask, best));
+      bestidx = _mm_or_pd(_mm_and_pd(mask, idx), _mm_andnot_pd(mask, bestidx));
+      idx = _mm_add_pd(idx, two);
+    }
+
+    double lanes[2], lanesidx[2];
+    _mm_storeu_pd(lanes, best);
+    _mm_storeu_pd(lanesidx, bestidx);
+
+    radius_square = lanes[0];
+    unsigned int farthest = static_cast<unsigned int>(lanesidx[0]);
+    if (lanes[1] > radius_square
+        || (lanes[1] == radius_square && lanesidx[1] > farthest)) {
+      radius_square = lanes[1];
+      farthest = static_cast<unsigned int>(lanesidx[1]);
+    }
+
+    for (; j < n; ++j) {
+      const double *a = p + std::size_t(j) * stride;
+      double dist = sqr(a[0] - center[0]);
+      dist += sqr(a[1] - center[1]);
+      dist += sqr(a[2] - center[2]);
+      if (dist >= radius_square) {
+        radius_square = dist;
+        farthest = j;
+      }
+    }
+    return farthest;
+  }
+#endif // SEB_FIXED_SSE2
+
+} // namespace SEB_NAMESPACE
+
+#endif // SEB_SEB_FIXED_H
@@ -0,0 +1,228 @@
+// Synopsis: Affine hull of a point set in compile-time dimension.
+//
+// Fixed dimension variant of Subspan (see Subspan.h) used by
+// Seb_fixed.h: the QR-decomposition lives in fixed size arrays and
+// membership is tracked through the at most Dim+1 members, so no heap
+// storage is needed at all.
+
+#ifndef SEB_SUBSPAN_FIXED_H
+#define SEB_SUBSPAN_FIXED_H
+
+#include <cmath>
+#include <numeric>
+#include "Seb_configure.h"
+#include "Subspan.h"
+
+namespace SEB_NAMESPACE {
+
+  template<typename Float, unsigned int Dim, class PointAccessor>
+  class Fixed_subspan
+  // See Subspan for a description of the data structure; this class
+  // provides the same interface with the dimension fixed to Dim.
+  {
+  public: // construction:
+
+    Fixed_subspan(const PointAccessor& S, unsigned int index)
+    : S(S)
+    {
+      reset(index);
+    }
+
+    void reset(unsigned int index)
+    // Reinitializes the instance to represent aff({S[index]}).
+    {
+      for (unsigned int i=0; i<Dim; ++i)
+        for (unsigned int j=0; j<Dim; ++j)
+          Q[i][j] = (i==j)? 1 : 0;
+      for (unsigned int i=0; i<Dim; ++i)
+        R[i] = Rstorage[i];
+      members[r = 0] = index;
+    }
+
+  public: // modification:
+
+    void add_point(unsigned int index)
+    {
+      SEB_ASSERT(!is_member(index));
+      for (unsigned int i=0; i<Dim; ++i)
+        u[i] = S[index][i] - origin(i);
+      append_column();
+      members[r+1] = members[r];
+      members[r]   = index;
+      ++r;
+    }
+
+    void remove_point(unsigned int local_index)
+    {
+      SEB_ASSERT(is_member(global_index(local_index)) && size() > 1);
+      if (local_index == r) {
+        for (unsigned int i=0; i<Dim; ++i)
+          u[i] = origin(i) - S[global_index(r-1)][i];
+        --r;
+        special_rank_1_update();
+      } else {
+        Float *dummy = R[local_index];
+        for (unsigned int j = local_index+1; j < r; ++j) {
+          R[j-1] = R[j];
+          members[j-1] = members[j];
+        }
+        members[r-1] = members[r];
+        R[--r] = dummy;
+        hessenberg_clear(local_index);
+      }
+    }
+
+  public: // access:
+
+    unsigned int size() const
+    {
+      return r+1;
+    }
+
+    bool is_member(unsigned int i) const
+    // Linear search over the at most Dim+1 members.
+    {
+      for (unsigned int j = 0; j <= r; ++j)
+        if (members[j] == i)
+          return true;
+      return false;
+    }
+
+    unsigned int global_index(unsigned int i) const
+    {
+      SEB_ASSERT(i < size());
+      return members[i];
+    }
+
+    unsigned int any_member() const
+    {
+      return members[r];
+    }
+
+    Float shortest_vector_to_span(const Float *p, Float *w)
+    {
+      for (unsigned int i=0; i<Dim; ++i)
+        w[i] = origin(i) - p[i];
+      for (unsigned int j = 0; j < r; ++j) {
+        const Float scale = std::inner_product(w,w+Dim,Q[j],Float(0));
+        for (unsigned int i = 0; i < Dim; ++i)
+          w[i] -= scale * Q[j][i];
+      }
+      return std::inner_product(w,w+Dim,w,Float(0));
+    }
+
+    void find_affine_coefficients(const Float *p, Float *lambdas)
+    {
+      for (unsigned int i=0; i<Dim; ++i)
+        u[i] = p[i] - origin(i);
+      for (unsigned int i = 0; i < Dim; ++i) {
+        w[i] = 0;
+        for (unsigned int k = 0; k < Dim; ++k)
+          w[i] += Q[i][k] * u[k];
+      }
+      Float origin_lambda = 1;
+      for (int j = r-1; j>=0; --j) {
+        for (unsigned int k=j+1; k<r; ++k)
+          w[j] -= lambdas[k] * R[k][j];
+        origin_lambda -= lambdas[j] = w[j] / R[j][j];
+      }
+      lambdas[r] = origin_lambda;
+    }
+
+  private: // helpers, cf. Subspan-inl.h:
+
+    Float origin(unsigned int i) const
+    {
+      return S[members[r]][i];
+    }
+
+    void append_column()
+    {
+      SEB_ASSERT(r < Dim);
+      for (unsigned int i = 0; i < Dim; ++i) {
+        R[r][i] = 0;
+        for (unsigned int k = 0; k < Dim; ++k)
+          R[r][i] += Q[i][k] * u[k];
+      }
+      for (unsigned int j = Dim-1; j > r; --j) {
+        Float c, s;
+        givens (c,s,R[r][j-1],R[r][j]);
+        R[r][j-1] = c * R[r][j-1] + s * R[r][j];
+        for (unsigned int i = 0; i < Dim; ++i) {
+          const Float a = Q[j-1][i];
+          const Float b = Q[j][i];
+          Q[j-1][i] =  c * a + s * b;
+          Q[j][i]   =  c * b - s * a;
+        }
+      }
+    }
+
+    void hessenberg_clear(unsigned int pos)
+    {
+      for (; pos < r; ++pos) {
+        Float c, s;
+        givens (c,s,R[pos][pos],R[pos][pos+1]);
+        R[pos][pos] = c * R[pos][pos] + s * R[pos][pos+1];
+        for (unsigned int j = pos+1; j < r; ++j) {
+          const Float a = R[j][pos];
+          const Float b = R[j][pos+1];
+          R[j][pos]   =  c * a + s * b;
+          R[j][pos+1] =  c * b - s * a;
+        }
+        for (unsigned int i = 0; i < Dim; ++i) {
+          const Float a = Q[pos][i];
+          const Float b = Q[pos+1][i];
+          Q[pos][i]   =  c * a + s * b;
+          Q[pos+1][i] =  c * b - s * a;
+        }
+      }
+    }
+
+    void special_rank_1_update()
+    {
+      for (unsigned int i = 0; i < Dim; ++i) {
+        w[i] = 0;
+        for (unsigned int k = 0; k < Dim; ++k)
+          w[i] += Q[i][k] * u[k];
+      }
+      for (unsigned int k = Dim-1; k > 0; --k) {
+        Float c, s;
+        givens (c,s,w[k-1],w[k]);
+        w[k-1] = c * w[k-1] + s * w[k];
+        R[k-1][k]    = -s * R[k-1][k-1];
+        R[k-1][k-1] *=  c;
+        for (unsigned int j = k; j < r; ++j) {
+          const Float a = R[j][k-1];
+          const Float b = R[j][k];
+          R[j][k-1] =  c * a + s * b;
+          R[j][k]   =  c * b - s * a;
+        }
+        for (unsigned int i = 0; i < Dim; ++i) {
+          const Float a = Q[k-1][i];
+          const Float b = Q[k][i];
+          Q[k-1][i] =  c * a + s * b;
+          Q[k][i]   =  c * b - s * a;
+        }
+      }
+      for (unsigned int j = 0; j < r; ++j)
+        R[j][0] += w[0];
+      hessenberg_clear(0);
+    }
+
+  private: // we forbid copying (R points into Rstorage):
+    Fixed_subspan(const Fixed_subspan&);
+    Fixed_subspan& operator=(const Fixed_subspan&);
+
+  private: // member fields:
+    const PointAccessor &S;
+    unsigned int members[Dim+1];
+    Float Q[Dim][Dim];
+    Float Rstorage[Dim][Dim];
+    Float *R[Dim];                     // columns of R, permuted in place
+    Float u[Dim], w[Dim];
+    unsigned int r;
+  };
+
+} // namespace SEB_NAMESPACE
+
+#endif // SEB_SUBSPAN_FIXED_H
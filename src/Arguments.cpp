@@ -17,28 +17,186 @@
  * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
 #include <iostream>
 #include "Arguments.h"
+#include "Import.h"
 
-Arguments::Arguments (void) : action_ (CONVERT), scale_ (1.0f), flipUV_ (true) {
+Arguments::Arguments (void) : action_ (CONVERT), threads_ (0), writers_ (4), incremental_ (false), profile_ (PROFILE_NONE) {
 }
 
 Arguments::~Arguments (void) {
 }
 
 void Arguments::usage (const char *argv0) {
-    std::cerr << "Usage: " << argv0 << " [-l|-m|-n|-a] [-s scale] inputfile" << std::endl << std::endl
+    std::cerr << "Usage: " << argv0 << " [-l|-m|-n|-a] [-s scale] [-j threads] [-w writers] [-o outputdir] [-L listfile] [--option[=value]...] inputfile..." << std::endl << std::endl
     << "  -l    outputs a list of files that will be generated" << std::endl
     << "  -m    outputs a list of materials used by the nodes" << std::endl
     << "  -n    outputs the node hierarchy" << std::endl
     << "  -a    outputs the animation data" << std::endl
     << "  -s    scale factor" << std::endl
-    << "  -f    flip UVs" << std::endl;
+    << "  -f    flip UVs" << std::endl
+    << "  -j    number of worker threads (default: number of cores)" << std::endl
+    << "  -w    number of files written concurrently (default: 4)" << std::endl
+    << "  -o    output directory; with several inputs each input gets its own subdirectory" << std::endl
+    << "  -L    read further input files from a list file, one per line" << std::endl << std::endl
+    << "  --incremental    only rewrite files whose content changed since the last run" << std::endl
+    << "  --bspheres=mode  submesh bounding spheres: exact (default) or fast (EPOS-26)" << std::endl
+    << "  --indices=mode   submesh index width: 16 (default, 32 bits where needed), adaptive (8, 16 or 32 bits)" << std::endl
+    << "                   or split (16 bits, nodes with too many vertices are split into chunks); the width follows" << std::endl
+    << "                   the range of vertices each submesh uses, counted from the base vertex in SUBMESHBASES" << std::endl
+    << "  --vertexcache[=size]  reorder triangles for a post-transform cache of the given size (default: 16)" << std::endl
+    << "  --vertexfetch    renumber vertices in the order the submeshes first use them" << std::endl
+    << "  --overdraw[=threshold]  order triangle clusters to reduce overdraw, allowing the ACMR to grow" << std::endl
+    << "                   by the given factor (default: 1.05)" << std::endl
+    << "  --quantize-positions=node|submesh  16 bit normalized positions relative to the bounds of each node" << std::endl
+    << "                   or submesh" << std::endl
+    << "  --quantize-normals=8|16  octahedral normals with 2x8 or 2x16 bits" << std::endl
+    << "  --quantize-texcoords=half|unorm16  texture coordinates as half floats or 16 bit normalized values" << std::endl
+    << "  --quantize       same as --quantize-positions=node --quantize-normals=16 --quantize-texcoords=half" << std::endl
+    << "  --meshlets[=vertices,triangles]  emit meshlets of at most that many vertices (up to 256) and" << std::endl
+    << "                   triangles with culling data for every submesh (default: 64,124)" << std::endl
+    << "  --lods[=count,ratio,maxerror]  emit count simplified levels of detail per submesh, each keeping about" << std::endl
+    << "                   ratio of the triangles of the previous one; collapses with an error above maxerror times" << std::endl
+    << "                   the largest extent of the submesh are skipped, so fewer triangles may be removed" << std::endl
+    << "                   (default: 3,0.5,0.01)" << std::endl
+    << "  --keyframes[=translation,scale,angle]  drop animation keys that interpolation reproduces within the" << std::endl
+    << "                   given tolerances (angle in degrees, default: 0.001,0.001,0.1) and export key times" << std::endl
+    << "  --resample=fps   sample every animation channel at a fixed rate" << std::endl
+    << "  --interleave     write all vertex attributes into one VERTICES set described by VERTEXLAYOUT" << std::endl
+    << "  --stream         write and free every node as soon as it is converted, so that memory use is bounded" << std::endl
+    << "                   by the nodes in flight rather than by the whole scene" << std::endl
+    << "  --import=profile  Assimp post processing: fast (triangulate, sort by primitive type, smooth normals)," << std::endl
+    << "                   default or full (default plus tangents, validation and invalid data removal)" << std::endl
+    << "  --import-steps=[+|-]step,...  add (or with -, remove) post processing steps, e.g. -improvecachelocality;" << std::endl
+    << "                   steps: " << ImportStepNames () << std::endl
+    << "  --import-timing  report the time spent reading each input and in each post processing step" << std::endl
+    << "  --mmap, --no-mmap  read input files through memory mappings (default on Linux) or Assimp's default" << std::endl
+    << "                   IO system" << std::endl
+    << "  --profile[=text|json]  report the time spent in each phase, in total and per node or file" << std::endl
+    << "  --profile-file=file  write the profile to a file instead of standard error" << std::endl;
+}
+
+bool Arguments::parseLongOption (const std::string &name, const std::string &value) {
+    if (name == "incremental" && value.empty ()) {
+        incremental_ = true;
+    } else if (name == "bspheres" && value == "exact") {
+        options_.bspheres = Options::BSPHERES_EXACT;
+    } else if (name == "bspheres" && value == "fast") {
+        options_.bspheres = Options::BSPHERES_FAST;
+    } else if (name == "indices" && value == "16") {
+        options_.indices = Options::INDICES_16;
+    } else if (name == "indices" && value == "adaptive") {
+        options_.indices = Options::INDICES_ADAPTIVE;
+    } else if (name == "indices" && value == "split") {
+        options_.indices = Options::INDICES_SPLIT;
+    } else if (name == "vertexcache") {
+        options_.vertexcache = value.empty () ? 16 : atoi (value.c_str ());
+        if (options_.vertexcache == 0) return false;
+    } else if (name == "vertexfetch" && value.empty ()) {
+        options_.vertexfetch = true;
+    } else if (name == "overdraw") {
+        options_.overdraw = value.empty () ? 1.05f : atof (value.c_str ());
+        if (options_.overdraw < 1.0f) return false;
+    } else if (name == "meshlets") {
+        options_.meshletvertices = 64;
+        options_.meshlettriangles = 124;
+        if (!value.empty ()) {
+            std::string::size_type comma = value.find (',');
+            if (comma == std::string::npos) return false;
+            options_.meshletvertices = atoi (value.substr (0, comma).c_str ());
+            options_.meshlettriangles = atoi (value.substr (comma + 1).c_str ());
+        }
+        if (options_.meshletvertices < 3 || options_.meshletvertices > 256 || options_.meshlettriangles < 1) {
+            return false;
+        }
+    } else if (name == "lods") {
+        options_.lods = 3;
+        options_.lodratio = 0.5f;
+        options_.lodmaxerror = 0.01f;
+        if (!value.empty ()) {
+            std::string::size_type comma = value.find (',');
+            options_.lods = atoi (value.substr (0, comma).c_str ());
+            if (comma != std::string::npos) {
+                options_.lodratio = atof (value.substr (comma + 1).c_str ());
+                comma = value.find (',', comma + 1);
+                if (comma != std::string::npos) {
+                    options_.lodmaxerror = atof (value.substr (comma + 1).c_str ());
+                }
+            }
+        }
+        if (options_.lods < 1 || !(options_.lodratio > 0.0f && options_.lodratio < 1.0f)
+            || !(options_.lodmaxerror > 0.0f)) {
+            return false;
+        }
+    } else if (name == "keyframes") {
+        options_.keyframes = true;
+        if (!value.empty ()) {
+            std::string::size_type first = value.find (',');
+            std::string::size_type second = first == std::string::npos ? first : value.find (',', first + 1);
+            if (second == std::string::npos) return false;
+            options_.keyframetranslation = atof (value.substr (0, first).c_str ());
+            options_.keyframescale = atof (value.substr (first + 1, second - first - 1).c_str ());
+            options_.keyframeangle = atof (value.substr (second + 1).c_str ()) * 3.14159265f / 180.0f;
+        }
+        if (options_.keyframetranslation < 0.0f || options_.keyframescale < 0.0f || options_.keyframeangle < 0.0f) {
+            return false;
+        }
+    } else if (name == "profile" && (value.empty () || value == "text")) {
+        profile_ = PROFILE_TEXT;
+    } else if (name == "profile" && value == "json") {
+        profile_ = PROFILE_JSON;
+    } else if (name == "profile-file" && !value.empty ()) {
+        profilefile_ = value;
+        if (profile_ == PROFILE_NONE) profile_ = PROFILE_TEXT;
+    } else if (name == "import") {
+        return ImportProfile (value, options_.postprocess);
+    } else if (name == "import-steps" && !value.empty ()) {
+        /* applied after all options, so that the order relative to --import does not matter */
+        importsteps_ += (importsteps_.empty () ? "" : ",") + value;
+    } else if (name == "import-timing" && value.empty ()) {
+        options_.importtiming = true;
+    } else if (name == "mmap" && value.empty ()) {
+        options_.mappedio = true;
+    } else if (name == "no-mmap" && value.empty ()) {
+        options_.mappedio = false;
+    } else if (name == "interleave" && value.empty ()) {
+        options_.interleave = true;
+    } else if (name == "stream" && value.empty ()) {
+        options_.streaming = true;
+    } else if (name == "resample") {
+        options_.resample = atof (value.c_str ());
+        if (!(options_.resample > 0.0f)) return false;
+    } else if (name == "quantize" && value.empty ()) {
+        options_.positions = Options::POSITIONS_NODE;
+        options_.normalbits = 16;
+        options_.texcoords = Options::TEXCOORDS_HALF;
+    } else if (name == "quantize-positions" && value == "node") {
+        options_.positions = Options::POSITIONS_NODE;
+    } else if (name == "quantize-positions" && value == "submesh") {
+        options_.positions = Options::POSITIONS_SUBMESH;
+    } else if (name == "quantize-normals" && (value == "8" || value == "16")) {
+        options_.normalbits = atoi (value.c_str ());
+    } else if (name == "quantize-texcoords" && value == "half") {
+        options_.texcoords = Options::TEXCOORDS_HALF;
+    } else if (name == "quantize-texcoords" && value == "unorm16") {
+        options_.texcoords = Options::TEXCOORDS_UNORM16;
+    } else {
+        return false;
+    }
+    return true;
 }
 
 bool Arguments::parse (int argc, char **argv) {
     for (auto i = 1; i < argc; i++) {
-        if (argv[i][0] == '-') {
+        if (argv[i][0] == '-' && argv[i][1] == '-') {
+            std::string option (argv[i] + 2);
+            std::string::size_type pos = option.find ('=');
+            std::string value = pos == std::string::npos ? std::string () : option.substr (pos + 1);
+            if (!parseLongOption (option.substr (0, pos), value)) {
+                throw std::runtime_error (std::string ("invalid argument: \"") + argv[i] + "\"");
+            }
+        } else if (argv[i][0] == '-') {
             if (argv[i][1] != 0 && argv[i][2] == 0) {
                 switch (argv[i][1]) {
                     case 'l':
@@ -54,7 +212,7 @@ bool Arguments::parse (int argc, char **argv) {
                         action_ = LIST_ANIMATIONDATA;
                         break;
                     case 'f':
-                        flipUV_ = false;
+                        options_.flipUV = false;
                         break;
                     case 's':
                     {
@@ -62,7 +220,52 @@ bool Arguments::parse (int argc, char **argv) {
                         if (i >= argc) {
                             throw std::runtime_error ("missing argument after -s");
                         }
-                        scale_ = atof (argv[i]);
+                        options_.scale = atof (argv[i]);
+                        break;
+                    }
+                    case 'j':
+                    {
+                        i++;
+                        if (i >= argc) {
+                            throw std::runtime_error ("missing argument after -j");
+                        }
+                        threads_ = atoi (argv[i]);
+                        break;
+                    }
+                    case 'w':
+                    {
+                        i++;
+                        if (i >= argc) {
+                            throw std::runtime_error ("missing argument after -w");
+                        }
+                        writers_ = atoi (argv[i]);
+                        break;
+                    }
+                    case 'o':
+                    {
+                        i++;
+                        if (i >= argc) {
+                            throw std::runtime_error ("missing argument after -o");
+                        }
+                        outputdir_ = argv[i];
+                        break;
+                    }
+                    case 'L':
+                    {
+                        i++;
+                        if (i >= argc) {
+                            throw std::runtime_error ("missing argument after -L");
+                        }
+                        std::ifstream list (argv[i]);
+                        if (!list) {
+                            throw std::runtime_error (std::string ("cannot open list file \"") + argv[i] + "\"");
+                        }
+                        std::string line;
+                        while (std::getline (list, line)) {
+                            if (!line.empty () && line.back () == '\r') line.pop_back ();
+                            if (line.empty () || line[0] == '#') continue;
+                            args.push_back (line);
+                        }
                         break;
                     }
                     default:
@@ -76,7 +279,13 @@ bool Arguments::parse (int argc, char **argv) {
             args.emplace_back (argv[i]);
         }
     }
-    if (args.size () != 1) {
+    if (!importsteps_.empty () && !ParseImportSteps (importsteps_, options_.postprocess)) {
+        throw std::runtime_error ("invalid post processing steps: \"" + importsteps_ + "\"");
+    }
+    if (options_.keyframes && options_.resample > 0.0f) {
+        throw std::runtime_error ("--keyframes and --resample cannot be combined");
+    }
+    if (args.empty ()) {
         usage (argv[0]);
         return false;
     }
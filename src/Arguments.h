@@ -20,9 +20,93 @@
 #ifndef ASSIMP2VF_ARGUMENTS_H
 #define ASSIMP2VF_ARGUMENTS_H
 
+#include <assimp/postprocess.h>
 #include <string>
 #include <vector>
 
+/* inputs are memory mapped by default where that is known to work well */
+#ifdef __linux__
+# define ASSIMP2VF_MAPPED_IO true
+#else
+# define ASSIMP2VF_MAPPED_IO false
+#endif
+
+/*
+ * Conversion settings. A copy is handed to every Scene, so that worker
+ * threads never have to touch the Arguments singleton.
+ */
+struct Options {
+    enum BSphereMode {
+        BSPHERES_EXACT,
+        BSPHERES_FAST
+    };
+    enum PositionQuantization {
+        POSITIONS_FLOAT,
+        POSITIONS_NODE,
+        POSITIONS_SUBMESH
+    };
+    enum TexcoordQuantization {
+        TEXCOORDS_FLOAT,
+        TEXCOORDS_HALF,
+        TEXCOORDS_UNORM16
+    };
+    enum IndexMode {
+        INDICES_16,
+        INDICES_ADAPTIVE,
+        INDICES_SPLIT
+    };
+    Options (void) : scale (1.0f), flipUV (true), bspheres (BSPHERES_EXACT), indices (INDICES_16),
+                     vertexcache (0), vertexfetch (false), overdraw (0.0f),
+                     positions (POSITIONS_FLOAT), normalbits (0), texcoords (TEXCOORDS_FLOAT),
+                     meshletvertices (0), meshlettriangles (0), lods (0), lodratio (0.5f), lodmaxerror (0.01f),
+                     keyframes (false), keyframetranslation (0.001f), keyframescale (0.001f),
+                     keyframeangle (0.1f * 3.14159265f / 180.0f), resample (0.0f), interleave (false), streaming (false),
+                     postprocess (aiProcess_GenSmoothNormals | aiProcess_Triangulate | aiProcess_GenUVCoords
+                                  | aiProcess_OptimizeMeshes | aiProcess_SortByPType | aiProcess_FindDegenerates
+                                  | aiProcess_ImproveCacheLocality),
+                     importtiming (false), mappedio (ASSIMP2VF_MAPPED_IO) {
+    }
+    float scale;
+    bool flipUV;
+    BSphereMode bspheres;
+    IndexMode indices;
+    /* post-transform cache size the triangles are ordered for, 0 keeps the input order */
+    unsigned int vertexcache;
+    /* renumber vertices in order of first use */
+    bool vertexfetch;
+    /* ACMR factor the overdraw pass may trade for less overdraw, 0 disables it */
+    float overdraw;
+    PositionQuantization positions;
+    /* bits per component of octahedral normals, 0 keeps floats */
+    unsigned int normalbits;
+    TexcoordQuantization texcoords;
+    /* maximum size of meshlets, 0 disables them */
+    unsigned int meshletvertices;
+    unsigned int meshlettriangles;
+    /* number of simplified index sets per submesh and the triangle ratio between levels */
+    unsigned int lods;
+    float lodratio;
+    /* largest simplification error allowed, relative to the largest extent of the submesh */
+    float lodmaxerror;
+    /* drop animation keys that interpolation reproduces within these tolerances (angle in radians) */
+    bool keyframes;
+    float keyframetranslation;
+    float keyframescale;
+    float keyframeangle;
+    /* rate animations are resampled at, 0 keeps the original keys */
+    float resample;
+    /* write all vertex attributes into a single VERTICES set */
+    bool interleave;
+    /* free the output of every node as soon as it is written, keeping only what the list actions need */
+    bool streaming;
+    /* Assimp post processing steps, aiProcess_FlipUVs is added according to flipUV */
+    unsigned int postprocess;
+    /* report the time spent reading and in every post processing step */
+    bool importtiming;
+    /* read input files through memory mappings instead of Assimp's default IO system */
+    bool mappedio;
+};
+
 class Arguments {
 public:
     Arguments (const Arguments&) = delete;
@@ -37,25 +121,59 @@ public:
     };
     static Arguments &get (void);
     void usage (const char *argv0);
+    bool parseLongOption (const std::string &name, const std::string &value);
     bool parse (int argc, char **argv);
-    const std::string &inputfile (void) const {
-        return args.front ();
+    const std::vector<std::string> &inputfiles (void) const {
+        return args;
+    }
+    const std::string &outputdir (void) const {
+        return outputdir_;
+    }
+    bool incremental (void) const {
+        return incremental_;
+    }
+    enum ProfileFormat {
+        PROFILE_NONE,
+        PROFILE_TEXT,
+        PROFILE_JSON
+    };
+    ProfileFormat profile (void) const {
+        return profile_;
+    }
+    /* file the profile is written to, empty for standard error */
+    const std::string &profilefile (void) const {
+        return profilefile_;
     }
 
     Action action (void) const {
         return action_;
     }
+    const Options &options (void) const {
+        return options_;
+    }
     float scale (void) const {
-        return scale_;
+        return options_.scale;
     }
     bool flipUV (void) const {
-        return flipUV_;
+        return options_.flipUV;
+    }
+    unsigned int threads (void) const {
+        return threads_;
+    }
+    unsigned int writers (void) const {
+        return writers_;
     }
 private:
     Arguments (void);
     Action action_;
-    float scale_;
-    bool flipUV_;
+    Options options_;
+    unsigned int threads_;
+    unsigned int writers_;
+    std::string outputdir_;
+    bool incremental_;
+    ProfileFormat profile_;
+    std::string profilefile_;
+    std::string importsteps_;
     std::vector<std::string> args;
 };
 
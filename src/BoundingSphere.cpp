@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BoundingSphere.h"
+#include <cmath>
+#include <miniball/Seb_fixed.h>
+
+BoundingSphere ExactBoundingSphere (const std::vector<double> &points) {
+    BoundingSphere sphere;
+    if (points.empty ()) return sphere;
+    Seb::Strided_point_accessor<double> accessor (points.data (), points.size () / 3, 3);
+    Seb::Fixed_smallest_enclosing_ball<double, 3> miniball (accessor);
+    sphere.center[0] = *(miniball.center_begin () + 0);
+    sphere.center[1] = *(miniball.center_begin () + 1);
+    sphere.center[2] = *(miniball.center_begin () + 2);
+    sphere.radius = miniball.radius ();
+    return sphere;
+}
+
+BoundingSphere FastBoundingSphere (const std::vector<double> &points, double &lowerbound) {
+    static const double directions[13][3] = {
+        { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 },
+        { 1, 1, 1 }, { 1, 1, -1 }, { 1, -1, 1 }, { 1, -1, -1 },
+        { 1, 1, 0 }, { 1, -1, 0 }, { 1, 0, 1 }, { 1, 0, -1 }, { 0, 1, 1 }, { 0, 1, -1 }
+    };
+    lowerbound = 0;
+    if (points.empty ()) return BoundingSphere ();
+
+    size_t extremes[26] = {};
+    double minproj[13], maxproj[13];
+    for (auto d = 0; d < 13; d++) {
+        minproj[d] = maxproj[d] = directions[d][0] * points[0] + directions[d][1] * points[1] + directions[d][2] * points[2];
+    }
+    for (auto i = 3; i < points.size (); i += 3) {
+        for (auto d = 0; d < 13; d++) {
+            double proj = directions[d][0] * points[i] + directions[d][1] * points[i + 1] + directions[d][2] * points[i + 2];
+            if (proj < minproj[d]) {
+                minproj[d] = proj;
+                extremes[d * 2] = i;
+            }
+            if (proj > maxproj[d]) {
+                maxproj[d] = proj;
+                extremes[d * 2 + 1] = i;
+            }
+        }
+    }
+
+    std::vector<double> extremepoints;
+    extremepoints.reserve (26 * 3);
+    for (auto i = 0; i < 26; i++) {
+        extremepoints.insert (extremepoints.end (), &points[extremes[i]], &points[extremes[i]] + 3);
+    }
+    BoundingSphere sphere = ExactBoundingSphere (extremepoints);
+    lowerbound = sphere.radius;
+
+    for (auto i = 0; i < points.size (); i += 3) {
+        double delta[3] = {
+            points[i] - sphere.center[0],
+            points[i + 1] - sphere.center[1],
+            points[i + 2] - sphere.center[2]
+        };
+        double distance = std::sqrt (delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+        if (distance > sphere.radius) {
+            double radius = (sphere.radius + distance) * 0.5;
+            double shift = (radius - sphere.radius) / distance;
+            sphere.center[0] += delta[0] * shift;
+            sphere.center[1] += delta[1] * shift;
+            sphere.center[2] += delta[2] * shift;
+            sphere.radius = radius;
+        }
+    }
+    return sphere;
+}
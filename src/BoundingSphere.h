@@ -0,0 +1,47 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_BOUNDINGSPHERE_H
+#define ASSIMP2VF_BOUNDINGSPHERE_H
+
+#include <vector>
+
+struct BoundingSphere {
+    BoundingSphere (void) : center { 0, 0, 0 }, radius (0) {
+    }
+    double center[3];
+    double radius;
+};
+
+/*
+ * Smallest enclosing sphere (Miniball) of points given as consecutive
+ * x, y, z triples.
+ */
+BoundingSphere ExactBoundingSphere (const std::vector<double> &points);
+
+/*
+ * EPOS-26 approximation: the exact sphere of the extremal points along 13
+ * fixed directions, grown Ritter style until it contains all points. The
+ * radius of the initial sphere is returned in lowerbound; the optimal
+ * radius is at least that large, so radius / lowerbound - 1 bounds the
+ * overshoot of the result.
+ */
+BoundingSphere FastBoundingSphere (const std::vector<double> &points, double &lowerbound);
+
+#endif /* !defined ASSIMP2VF_BOUNDINGSPHERE_H */
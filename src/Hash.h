@@ -0,0 +1,78 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_HASH_H
+#define ASSIMP2VF_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/*
+ * Stable 64 bit content hash (not cryptographic). Data is consumed in
+ * 8 byte words, so hashing large vertex buffers stays memory bound.
+ */
+class ContentHash {
+public:
+    ContentHash (void) : h (0xcbf29ce484222325ull), length (0) {
+    }
+    void Update (const void *data, size_t size) {
+        const unsigned char *p = static_cast<const unsigned char*> (data);
+        length += size;
+        for (; size >= 8; p += 8, size -= 8) {
+            uint64_t word;
+            std::memcpy (&word, p, 8);
+            Mix (word);
+        }
+        if (size > 0) {
+            uint64_t word = 0;
+            std::memcpy (&word, p, size);
+            Mix (word ^ (uint64_t (size) << 56));
+        }
+    }
+    template<typename T>
+    void Update (const T &value) {
+        Update (&value, sizeof (value));
+    }
+    void Update (const std::string &str) {
+        Update (str.size ());
+        Update (str.data (), str.size ());
+    }
+    uint64_t Get (void) const {
+        uint64_t x = h ^ length;
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+private:
+    void Mix (uint64_t word) {
+        word *= 0x87c37b91114253d5ull;
+        word = (word << 31) | (word >> 33);
+        word *= 0x4cf5ad432745937full;
+        h ^= word;
+        h = ((h << 27) | (h >> 37)) * 5 + 0x52dce729;
+    }
+    uint64_t h;
+    uint64_t length;
+};
+
+#endif /* !defined ASSIMP2VF_HASH_H */
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Import.h"
+#include "MappedIO.h"
+#include "Profiler.h"
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+struct PostProcessStep {
+    const char *name;
+    unsigned int flag;
+};
+
+/*
+ * In the order in which ReadFile applies them: validation first, then the
+ * steps as Assimp registers them. Assimp runs splitlargemeshes in two
+ * parts, by triangles before gennormals and by vertices after
+ * joinidenticalvertices; a single step can only be applied as a whole, so
+ * with --import-timing both parts run at the first position.
+ */
+const PostProcessStep steps[] = {
+    { "validatedatastructure", aiProcess_ValidateDataStructure },
+    { "makelefthanded", aiProcess_MakeLeftHanded },
+    { "flipuvs", aiProcess_FlipUVs },
+    { "flipwindingorder", aiProcess_FlipWindingOrder },
+    { "removeredundantmaterials", aiProcess_RemoveRedundantMaterials },
+    { "findinstances", aiProcess_FindInstances },
+    { "optimizegraph", aiProcess_OptimizeGraph },
+    { "optimizemeshes", aiProcess_OptimizeMeshes },
+    { "finddegenerates", aiProcess_FindDegenerates },
+    { "genuvcoords", aiProcess_GenUVCoords },
+    { "transformuvcoords", aiProcess_TransformUVCoords },
+    { "pretransformvertices", aiProcess_PreTransformVertices },
+    { "triangulate", aiProcess_Triangulate },
+    { "sortbyptype", aiProcess_SortByPType },
+    { "findinvaliddata", aiProcess_FindInvalidData },
+    { "fixinfacingnormals", aiProcess_FixInfacingNormals },
+    { "splitbybonecount", aiProcess_SplitByBoneCount },
+    { "splitlargemeshes", aiProcess_SplitLargeMeshes },
+    { "gennormals", aiProcess_GenNormals },
+    { "gensmoothnormals", aiProcess_GenSmoothNormals },
+    { "calctangentspace", aiProcess_CalcTangentSpace },
+    { "joinidenticalvertices", aiProcess_JoinIdenticalVertices },
+    { "debone", aiProcess_Debone },
+    { "limitboneweights", aiProcess_LimitBoneWeights },
+    { "improvecachelocality", aiProcess_ImproveCacheLocality }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double Milliseconds (Clock::time_point begin, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli> (end - begin).count ();
+}
+
+/*
+ * Remembers when Assimp last reported reading progress, which separates
+ * parsing from the scene validation and preprocessing done by ReadFile.
+ */
+class TimingProgressHandler : public Assimp::ProgressHandler {
+public:
+    TimingProgressHandler (void) : reported (false) {
+    }
+    bool Update (float) override {
+        return true;
+    }
+    void UpdateFileRead (int, int) override {
+        lastread = Clock::now ();
+        reported = true;
+    }
+    bool reported;
+    Clock::time_point lastread;
+};
+
+std::mutex mutex;
+/* idle Importers with Assimp's default IO system and with a MappedIOSystem */
+std::vector<std::unique_ptr<Assimp::Importer>> importers[2];
+
+/*
+ * The IO system is installed once when the Importer is created: Assimp's
+ * SetIOHandler (nullptr) allocates a new default IO system every time.
+ */
+std::unique_ptr<Assimp::Importer> AcquireImporter (bool mappedio) {
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (!importers[mappedio].empty ()) {
+            std::unique_ptr<Assimp::Importer> importer (std::move (importers[mappedio].back ()));
+            importers[mappedio].pop_back ();
+            return importer;
+        }
+    }
+    std::unique_ptr<Assimp::Importer> importer (new Assimp::Importer);
+    if (mappedio) {
+        /* the Importer takes ownership */
+        importer->SetIOHandler (new MappedIOSystem);
+    }
+#ifdef AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES
+    importer->SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES, true);
+#else
+# warning "AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES not supported by assimp! Falling back to using id tags as names instead."
+#endif
+    return importer;
+}
+
+void ReleaseImporter (Assimp::Importer *importer, bool mappedio) {
+    importer->FreeScene ();
+    std::lock_guard<std::mutex> lock (mutex);
+    importers[mappedio].emplace_back (importer);
+}
+
+/*
+ * Reads the file without post processing and then applies the steps one
+ * by one, reporting the time spent in each.
+ */
+const aiScene *ReadFileTimed (Assimp::Importer &importer, const std::string &filename, unsigned int flags) {
+    TimingProgressHandler handler;
+    std::ostringstream report;
+    importer.SetProgressHandler (&handler);
+    const Clock::time_point begin = Clock::now ();
+    const aiScene *aiscene = importer.ReadFile (filename, 0);
+    const Clock::time_point read = Clock::now ();
+    report << filename << ": reading " << Milliseconds (begin, read) << " ms";
+    if (handler.reported) {
+        report << " (parsing " << Milliseconds (begin, handler.lastread) << " ms)";
+    }
+    double total = Milliseconds (begin, read);
+    for (auto &step : steps) {
+        if (!aiscene || !(flags & step.flag)) continue;
+        const Clock::time_point start = Clock::now ();
+        aiscene = importer.ApplyPostProcessing (step.flag);
+        const double duration = Milliseconds (start, Clock::now ());
+        report << ", " << step.name << " " << duration << " ms";
+        total += duration;
+    }
+    importer.SetProgressHandler (nullptr);
+    report << ", total " << total << " ms" << std::endl;
+    std::cerr << report.str ();
+    return aiscene;
+}
+}
+
+bool ImportProfile (const std::string &name, unsigned int &flags) {
+    if (name == "fast") {
+        flags = aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_GenSmoothNormals;
+    } else if (name == "default") {
+        flags = Options ().postprocess;
+    } else if (name == "full") {
+        flags = Options ().postprocess | aiProcess_CalcTangentSpace | aiProcess_ValidateDataStructure
+                | aiProcess_FindInvalidData;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseImportSteps (const std::string &list, unsigned int &flags) {
+    std::istringstream stream (list);
+    std::string name;
+    while (std::getline (stream, name, ',')) {
+        const bool remove = !name.empty () && name[0] == '-';
+        if (!name.empty () && (name[0] == '-' || name[0] == '+')) name.erase (0, 1);
+        bool found = false;
+        for (auto &step : steps) {
+            if (name == step.name) {
+                flags = remove ? flags & ~step.flag : flags | step.flag;
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+std::string ImportStepNames (void) {
+    std::string names;
+    for (auto &step : steps) {
+        names += (names.empty () ? "" : " ") + std::string (step.name);
+    }
+    return names;
+}
+
+std::shared_ptr<aiScene> Import (const std::string &filename, const Options &options, std::string &error) {
+    const bool mappedio = options.mappedio;
+    std::unique_ptr<Assimp::Importer> importer (AcquireImporter (mappedio));
+    const unsigned int flags = options.postprocess | (options.flipUV ? aiProcess_FlipUVs : 0);
+    const aiScene *aiscene;
+    {
+        ProfileScope profile ("import", filename);
+        aiscene = options.importtiming ? ReadFileTimed (*importer, filename, flags)
+                                       : importer->ReadFile (filename, flags);
+    }
+    if (!aiscene) {
+        error = importer->GetErrorString ();
+        ReleaseImporter (importer.release (), mappedio);
+        return std::shared_ptr<aiScene> ();
+    }
+    /* the caller may free parts of the scene early, so it has to own it */
+    Assimp::Importer *owner = importer.release ();
+    return std::shared_ptr<aiScene> (owner->GetOrphanedScene (), [owner, mappedio] (aiScene *aiscene) {
+        delete aiscene;
+        ReleaseImporter (owner, mappedio);
+    });
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_IMPORT_H
+#define ASSIMP2VF_IMPORT_H
+
+#include <assimp/scene.h>
+#include <memory>
+#include <string>
+#include "Arguments.h"
+
+/*
+ * Reads an input file with the post processing steps selected in the
+ * options. The returned scene is owned by the caller and keeps its
+ * Importer alive; once the last reference is dropped the scene is deleted
+ * and the Importer is recycled for later calls. Returns
+ * an empty pointer and sets error on failure. Safe to call from several
+ * threads. With options.importtiming the steps are applied one at a time
+ * and the time spent in each is written to std::cerr.
+ */
+std::shared_ptr<aiScene> Import (const std::string &filename, const Options &options, std::string &error);
+
+/*
+ * Sets flags to the post processing steps of a profile: fast, default or
+ * full. Returns false for unknown profiles.
+ */
+bool ImportProfile (const std::string &name, unsigned int &flags);
+
+/*
+ * Adds the steps of a comma separated list of step names to flags, or
+ * removes those prefixed with '-'. Returns false for unknown steps.
+ */
+bool ParseImportSteps (const std::string &list, unsigned int &flags);
+
+/* space separated names accepted by ParseImportSteps */
+std::string ImportStepNames (void);
+
+#endif /* !defined ASSIMP2VF_IMPORT_H */
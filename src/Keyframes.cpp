@@ -0,0 +1,101 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Keyframes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float Distance (const aiVector3D &a, const aiVector3D &b) {
+    return (a - b).Length ();
+}
+
+aiVector3D Interpolate (const aiVectorKey &a, const aiVectorKey &b, double time) {
+    const float f = b.mTime > a.mTime ? float ((time - a.mTime) / (b.mTime - a.mTime)) : 0.0f;
+    return a.mValue + f * (b.mValue - a.mValue);
+}
+
+float Distance (const aiQuaternion &a, const aiQuaternion &b) {
+    return QuatAngle (a, b);
+}
+
+aiQuaternion Interpolate (const aiQuatKey &a, const aiQuatKey &b, double time) {
+    const float f = b.mTime > a.mTime ? float ((time - a.mTime) / (b.mTime - a.mTime)) : 0.0f;
+    aiQuaternion result;
+    aiQuaternion::Interpolate (result, a.mValue, b.mValue, f);
+    return result.Normalize ();
+}
+
+/*
+ * Longest run of keys a single segment may span. Extending a segment tests
+ * every key it spans again, so this bounds the reduction to O(n) instead
+ * of O(n^2) on long, nearly linear channels.
+ */
+const unsigned int maxsegment = 256;
+
+/*
+ * Greedy reduction: starting from the last kept key, a segment is extended
+ * as long as interpolating across it reproduces all keys it spans.
+ */
+template<typename Key>
+std::vector<uint32_t> ReduceKeys (const Key *keys, unsigned int count, float tolerance) {
+    std::vector<uint32_t> kept;
+    if (count == 0) return kept;
+    kept.push_back (0);
+
+    bool constant = true;
+    for (auto i = 1; i < count && constant; i++) {
+        constant = Distance (keys[i].mValue, keys[0].mValue) <= tolerance;
+    }
+    if (constant) return kept;
+
+    unsigned int anchor = 0;
+    for (unsigned int end = 2; end < count; end++) {
+        if (end - anchor > maxsegment) {
+            anchor = end - 1;
+            kept.push_back (anchor);
+            continue;
+        }
+        for (auto i = anchor + 1; i < end; i++) {
+            if (Distance (Interpolate (keys[anchor], keys[end], keys[i].mTime), keys[i].mValue) > tolerance) {
+                anchor = end - 1;
+                kept.push_back (anchor);
+                break;
+            }
+        }
+    }
+    kept.push_back (count - 1);
+    return kept;
+}
+
+}
+
+float QuatAngle (const aiQuaternion &a, const aiQuaternion &b) {
+    const float dot = std::fabs (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    return 2.0f * std::acos (std::min (dot, 1.0f));
+}
+
+std::vector<uint32_t> ReduceVectorKeys (const aiVectorKey *keys, unsigned int count, float tolerance) {
+    return ReduceKeys (keys, count, tolerance);
+}
+
+std::vector<uint32_t> ReduceQuatKeys (const aiQuatKey *keys, unsigned int count, float tolerance) {
+    return ReduceKeys (keys, count, tolerance);
+}
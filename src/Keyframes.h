@@ -0,0 +1,44 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_KEYFRAMES_H
+#define ASSIMP2VF_KEYFRAMES_H
+
+#include <assimp/scene.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Key reduction for animation channels. Both functions return the indices
+ * of the keys to keep, so that interpolating between kept keys by their
+ * times (lerp for vectors, slerp for quaternions) reproduces every dropped
+ * key within tolerance: a distance for vectors, an angle in radians for
+ * quaternions. The first and the last key are always kept, unless all keys
+ * lie within tolerance of the first, in which case only that one remains.
+ * No two kept keys are more than 256 keys apart.
+ */
+std::vector<uint32_t> ReduceVectorKeys (const aiVectorKey *keys, unsigned int count, float tolerance);
+std::vector<uint32_t> ReduceQuatKeys (const aiQuatKey *keys, unsigned int count, float tolerance);
+
+/*
+ * Angle in radians of the rotation from a to b.
+ */
+float QuatAngle (const aiQuaternion &a, const aiQuaternion &b);
+
+#endif /* !defined ASSIMP2VF_KEYFRAMES_H */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Manifest.h"
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace {
+const char *manifestname = ".assimp2vf-manifest";
+}
+
+Manifest::Manifest (const std::string &outputdir_) : outputdir (outputdir_), skipped (0), written (0) {
+    std::ifstream file (outputdir + manifestname);
+    Entry entry;
+    std::string filename;
+    while (file >> std::hex >> entry.hash >> std::dec >> entry.size >> entry.mtime && std::getline (file >> std::ws, filename)) {
+        entries[filename] = entry;
+    }
+}
+
+Manifest::~Manifest (void) {
+}
+
+bool Manifest::Stat (const std::string &filename, uint64_t &size, int64_t &mtime) const {
+    struct stat st;
+    if (stat ((outputdir + filename).c_str (), &st) != 0) return false;
+    size = st.st_size;
+    mtime = st.st_mtime;
+    return true;
+}
+
+bool Manifest::IsUnchanged (const std::string &filename, uint64_t hash) {
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = entries.find (filename);
+    if (it == entries.end () || it->second.hash != hash) return false;
+    uint64_t size;
+    int64_t mtime;
+    if (!Stat (filename, size, mtime) || size != it->second.size || mtime != it->second.mtime) return false;
+    it->second.current = true;
+    skipped++;
+    return true;
+}
+
+void Manifest::Update (const std::string &filename, uint64_t hash) {
+    Entry entry;
+    entry.hash = hash;
+    entry.current = Stat (filename, entry.size, entry.mtime);
+    std::lock_guard<std::mutex> lock (mutex);
+    entries[filename] = entry;
+    written++;
+}
+
+void Manifest::Save (void) {
+    std::lock_guard<std::mutex> lock (mutex);
+    std::ofstream file (outputdir + manifestname, std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error ("cannot write " + outputdir + manifestname);
+    }
+    for (auto &entry : entries) {
+        if (!entry.second.current) continue;
+        file << std::hex << entry.second.hash << std::dec << " " << entry.second.size << " "
+             << entry.second.mtime << " " << entry.first << std::endl;
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_MANIFEST_H
+#define ASSIMP2VF_MANIFEST_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/*
+ * Sidecar file in an output directory that records the content hash of
+ * every file written there, together with the size and modification time
+ * the file had after writing. All methods are thread-safe.
+ */
+class Manifest {
+public:
+    Manifest (const std::string &outputdir);
+    ~Manifest (void);
+    /*
+     * Returns true if the file was written with the same hash by an earlier
+     * run and is still unmodified on disk.
+     */
+    bool IsUnchanged (const std::string &filename, uint64_t hash);
+    void Update (const std::string &filename, uint64_t hash);
+    void Save (void);
+    unsigned int GetNumSkipped (void) const {
+        return skipped;
+    }
+    unsigned int GetNumWritten (void) const {
+        return written;
+    }
+private:
+    struct Entry {
+        Entry (void) : hash (0), size (0), mtime (0), current (false) {
+        }
+        uint64_t hash;
+        uint64_t size;
+        int64_t mtime;
+        bool current;
+    };
+    bool Stat (const std::string &filename, uint64_t &size, int64_t &mtime) const;
+    const std::string outputdir;
+    std::map<std::string, Entry> entries;
+    std::mutex mutex;
+    unsigned int skipped;
+    unsigned int written;
+};
+
+#endif /* !defined ASSIMP2VF_MANIFEST_H */
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedIO.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedIOStream::MappedIOStream (const unsigned char *data_, size_t size_) : data (data_), size (size_), position (0) {
+}
+
+MappedIOStream::~MappedIOStream (void) {
+    munmap (const_cast<unsigned char*> (data), size);
+}
+
+size_t MappedIOStream::Read (void *buffer, size_t elementsize, size_t count) {
+    if (elementsize == 0) return 0;
+    /* like fread, a partial element at the end is consumed but not counted */
+    const size_t available = size - position;
+    const size_t bytes = count > available / elementsize ? available : count * elementsize;
+    if (bytes > 0) std::memcpy (buffer, data + position, bytes);
+    position += bytes;
+    return bytes / elementsize;
+}
+
+size_t MappedIOStream::Write (const void*, size_t, size_t) {
+    return 0;
+}
+
+aiReturn MappedIOStream::Seek (size_t offset, aiOrigin origin) {
+    /* negative offsets arrive wrapped around, as with fseek, and wrap back here */
+    size_t target;
+    switch (origin) {
+        case aiOrigin_SET:
+            target = offset;
+            break;
+        case aiOrigin_CUR:
+            target = position + offset;
+            break;
+        case aiOrigin_END:
+            target = size + offset;
+            break;
+        default:
+            return aiReturn_FAILURE;
+    }
+    if (target > size) return aiReturn_FAILURE;
+    position = target;
+    return aiReturn_SUCCESS;
+}
+
+size_t MappedIOStream::Tell (void) const {
+    return position;
+}
+
+size_t MappedIOStream::FileSize (void) const {
+    return size;
+}
+
+void MappedIOStream::Flush (void) {
+}
+
+Assimp::IOStream *MappedIOSystem::Open (const char *file, const char *mode) {
+    if (std::strpbrk (mode, "wa+")) {
+        return DefaultIOSystem::Open (file, mode);
+    }
+    int fd = open (file, O_RDONLY);
+    if (fd < 0) {
+        return DefaultIOSystem::Open (file, mode);
+    }
+    struct stat info;
+    if (fstat (fd, &info) != 0 || !S_ISREG (info.st_mode) || info.st_size == 0) {
+        close (fd);
+        return DefaultIOSystem::Open (file, mode);
+    }
+    const size_t size = info.st_size;
+    void *data = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    /* the mapping stays valid after the descriptor is closed */
+    close (fd);
+    if (data == MAP_FAILED) {
+        return DefaultIOSystem::Open (file, mode);
+    }
+    madvise (data, size, MADV_SEQUENTIAL);
+    return new MappedIOStream (static_cast<const unsigned char*> (data), size);
+}
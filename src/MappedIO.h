@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_MAPPEDIO_H
+#define ASSIMP2VF_MAPPEDIO_H
+
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/IOStream.hpp>
+#include <cstddef>
+
+/*
+ * Read-only IOStream over a memory mapped file. Reads copy straight from
+ * the page cache, without a stdio buffer in between.
+ */
+class MappedIOStream : public Assimp::IOStream {
+public:
+    /* takes over a mapping of size bytes, which is unmapped on destruction */
+    MappedIOStream (const unsigned char *data, size_t size);
+    MappedIOStream (const MappedIOStream&) = delete;
+    ~MappedIOStream (void);
+    MappedIOStream &operator= (const MappedIOStream&) = delete;
+    size_t Read (void *buffer, size_t size, size_t count) override;
+    size_t Write (const void *buffer, size_t size, size_t count) override;
+    aiReturn Seek (size_t offset, aiOrigin origin) override;
+    size_t Tell (void) const override;
+    size_t FileSize (void) const override;
+    void Flush (void) override;
+private:
+    const unsigned char *data;
+    size_t size;
+    size_t position;
+};
+
+/*
+ * Maps files opened for reading, with a hint that they are read
+ * sequentially. Files opened for writing, empty files and files that
+ * cannot be mapped are handled by Assimp's default IO system.
+ */
+class MappedIOSystem : public Assimp::DefaultIOSystem {
+public:
+    Assimp::IOStream *Open (const char *file, const char *mode = "rb") override;
+};
+
+#endif /* !defined ASSIMP2VF_MAPPEDIO_H */
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include "BoundingSphere.h"
+
+Meshlets BuildMeshlets (const std::vector<uint32_t> &indices, unsigned int numvertices,
+                        unsigned int maxvertices, unsigned int maxtriangles) {
+    Meshlets result;
+    /* index of each vertex within the current meshlet, valid if present */
+    std::vector<uint8_t> local (numvertices, 0);
+    std::vector<bool> present (numvertices, false);
+    Meshlet current = { 0, 0, 0, 0 };
+
+    auto finish = [&] () {
+        if (current.trianglecount == 0) return;
+        for (auto i = current.vertexoffset; i < current.vertexoffset + current.vertexcount; i++) {
+            present[result.vertices[i]] = false;
+        }
+        result.meshlets.push_back (current);
+        current.vertexoffset += current.vertexcount;
+        current.vertexcount = 0;
+        current.triangleoffset += current.trianglecount;
+        current.trianglecount = 0;
+    };
+
+    for (size_t t = 0; t + 2 < indices.size (); t += 3) {
+        const uint32_t *triangle = &indices[t];
+        unsigned int added = 0;
+        for (auto i = 0; i < 3; i++) {
+            if (!present[triangle[i]] && std::find (triangle, triangle + i, triangle[i]) == triangle + i) added++;
+        }
+        if (current.vertexcount + added > maxvertices || current.trianglecount + 1 > maxtriangles) {
+            finish ();
+        }
+        for (auto i = 0; i < 3; i++) {
+            const uint32_t v = triangle[i];
+            if (!present[v]) {
+                present[v] = true;
+                local[v] = current.vertexcount++;
+                result.vertices.push_back (v);
+            }
+            result.triangles.push_back (local[v]);
+        }
+        current.trianglecount++;
+    }
+    finish ();
+    return result;
+}
+
+MeshletBounds ComputeMeshletBounds (const Meshlets &meshlets, const Meshlet &meshlet, const float *positions) {
+    MeshletBounds bounds;
+    std::vector<double> points;
+    points.reserve (meshlet.vertexcount * 3);
+    for (auto i = 0; i < meshlet.vertexcount; i++) {
+        const float *p = &positions[meshlets.vertices[meshlet.vertexoffset + i] * 3];
+        points.insert (points.end (), p, p + 3);
+    }
+    BoundingSphere sphere = ExactBoundingSphere (points);
+    std::copy (sphere.center, sphere.center + 3, bounds.center);
+    bounds.radius = sphere.radius;
+
+    /* unit triangle normals, their normalized mean is the cone axis */
+    std::vector<float> normals;
+    normals.reserve (meshlet.trianglecount * 3);
+    float axis[3] = { 0, 0, 0 };
+    for (auto t = 0; t < meshlet.trianglecount; t++) {
+        const uint8_t *corners = &meshlets.triangles[(meshlet.triangleoffset + t) * 3];
+        const float *a = &positions[meshlets.vertices[meshlet.vertexoffset + corners[0]] * 3];
+        const float *b = &positions[meshlets.vertices[meshlet.vertexoffset + corners[1]] * 3];
+        const float *c = &positions[meshlets.vertices[meshlet.vertexoffset + corners[2]] * 3];
+        const float u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const float v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        float n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+        const float length = std::sqrt (n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        /* degenerate triangles are invisible and do not constrain the cone */
+        if (length == 0) continue;
+        for (auto i = 0; i < 3; i++) {
+            n[i] /= length;
+            axis[i] += n[i];
+        }
+        normals.insert (normals.end (), n, n + 3);
+    }
+    const float length = std::sqrt (axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    float mindot = 1.0f;
+    if (length > 0) {
+        for (auto &a : axis) a /= length;
+        for (size_t i = 0; i < normals.size (); i += 3) {
+            mindot = std::min (mindot, axis[0] * normals[i] + axis[1] * normals[i + 1] + axis[2] * normals[i + 2]);
+        }
+    }
+    std::copy (axis, axis + 3, bounds.axis);
+    /* cones wider than about 84 degrees are useless for culling */
+    bounds.cutoff = (length > 0 && mindot > 0.1f) ? std::sqrt (1.0f - mindot * mindot) : 1.0f;
+    return bounds;
+}
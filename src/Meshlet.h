@@ -0,0 +1,66 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_MESHLET_H
+#define ASSIMP2VF_MESHLET_H
+
+#include <cstdint>
+#include <vector>
+
+struct Meshlet {
+    /* range in Meshlets::vertices */
+    uint32_t vertexoffset;
+    uint32_t vertexcount;
+    /* range of triangles in Meshlets::triangles, three entries each */
+    uint32_t triangleoffset;
+    uint32_t trianglecount;
+};
+
+struct Meshlets {
+    std::vector<Meshlet> meshlets;
+    /* vertex indices referenced by the meshlets */
+    std::vector<uint32_t> vertices;
+    /* triangle corners as indices into the meshlet's vertex range */
+    std::vector<uint8_t> triangles;
+};
+
+/*
+ * Cuts a triangle list into meshlets of at most maxvertices (up to 256)
+ * vertices and maxtriangles triangles, keeping the triangle order; the
+ * list should be vertex cache optimized for compact meshlets.
+ */
+Meshlets BuildMeshlets (const std::vector<uint32_t> &indices, unsigned int numvertices,
+                        unsigned int maxvertices, unsigned int maxtriangles);
+
+struct MeshletBounds {
+    double center[3];
+    double radius;
+    /*
+     * Normal cone: all triangles of the meshlet are back facing for a camera
+     * at c if dot (center - c, axis) >= cutoff * |center - c| + radius.
+     * A cutoff of 1 means the meshlet can not be culled this way.
+     */
+    float axis[3];
+    float cutoff;
+};
+
+/* Bounds of a meshlet, positions given as consecutive x, y, z triples. */
+MeshletBounds ComputeMeshletBounds (const Meshlets &meshlets, const Meshlet &meshlet, const float *positions);
+
+#endif /* !defined ASSIMP2VF_MESHLET_H */
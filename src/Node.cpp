@@ -18,68 +18,764 @@
  */
 
 #include "Node.h"
-#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include "Scene.h"
-#include "Arguments.h"
-#include <miniball/Seb.h>
+#include "Vertex.h"
+#include "BoundingSphere.h"
+#include "VertexCache.h"
+#include "Overdraw.h"
+#include "Quantize.h"
+#include "Meshlet.h"
+#include "Simplify.h"
+#include "Profiler.h"
 
-Node::Node (Scene *scene_) : scene (scene_), type (Container), vf (vfAlloc ()) {
+Node::Node (Scene *scene_) : output (false), type (Container), scene (scene_) {
 }
 
 Node::~Node (void) {
-    vfFree (vf);
-}
-
-struct Vertex {
-    Vertex (const aiVector3D &position, const aiVector3D &normal, const std::vector<aiVector3D> &texcoords) {
-        x = position.x;
-        y = position.y;
-        z = position.z;
-        nx = normal.x;
-        ny = normal.y;
-        nz = normal.z;
-        tx.reserve (texcoords.size ());
-        ty.reserve (texcoords.size ());
-        for (auto &texcoord : texcoords) {
-            tx.push_back (texcoord.x);
-            ty.push_back (texcoord.y);
-        }
-    }
-    bool operator< (const Vertex &rhs) const {
-        if (x < rhs.x) return true;
-        if (rhs.x < x) return false;
-        if (y < rhs.y) return true;
-        if (rhs.y < y) return false;
-        if (z < rhs.z) return true;
-        if (rhs.z < z) return false;
-        if (nx < rhs.nx) return true;
-        if (rhs.nx < nx) return false;
-        if (ny < rhs.ny) return true;
-        if (rhs.ny < ny) return false;
-        if (nz < rhs.nz) return true;
-        if (rhs.nz < nz) return false;
-        if (tx.size () < rhs.tx.size ()) return true;
-        if (rhs.tx.size () < tx.size ()) return false;
-        for (auto i = 0; i < tx.size (); i++) {
-            if (tx[i] < rhs.tx[i]) return true;
-            if (rhs.tx[i] < tx[i]) return false;
-            if (ty[i] < rhs.ty[i]) return true;
-            if (rhs.ty[i] < ty[i]) return false;
+}
+
+/*
+ * Narrowest of 8 (if allowed), 16 or 32 bits that can hold maxindex.
+ */
+static unsigned int IndexBits (uint32_t maxindex, bool allow8bit) {
+    if (allow8bit && maxindex <= 255) return 8;
+    return maxindex <= 65535 ? 16 : 32;
+}
+
+/*
+ * Adds a SUBMESH set with the narrowest of 8 (if allowed), 16 or 32 bit
+ * indices that can address all indices. Returns the number of bits used.
+ */
+static unsigned int AddIndexSet (VF &vf, const std::string &name, const std::vector<uint32_t> &indices,
+                                 bool allow8bit) {
+    const uint32_t maxindex = indices.empty () ? 0 : *std::max_element (indices.begin (), indices.end ());
+    const unsigned int bits = IndexBits (maxindex, allow8bit);
+    if (bits == 8) {
+        std::vector<uint8_t> narrow (indices.begin (), indices.end ());
+        vf.AddSet (name, 3, VF_UNSIGNED_BYTE, narrow.size () / 3, narrow.data ());
+    } else if (bits == 16) {
+        std::vector<uint16_t> narrow (indices.begin (), indices.end ());
+        vf.AddSet (name, 3, VF_UNSIGNED_SHORT, narrow.size () / 3, narrow.data ());
+    } else {
+        vf.AddSet (name, 3, VF_UNSIGNED_INT, indices.size () / 3, indices.data ());
+    }
+    return bits;
+}
+
+template<unsigned int NumUVChannels, bool HasNormals>
+void Node::LoadMesh (const aiNode *node, const std::vector<unsigned int> &submesh_order) {
+    typedef Vertex<NumUVChannels, HasNormals> vertex_type;
+    const Options &options = scene->GetOptions ();
+    const float scale = options.scale;
+    /* in split mode every chunk of vertices has to be addressable with 16 bits */
+    const bool split = options.indices == Options::INDICES_SPLIT;
+
+    size_t numcorners = 0;
+    for (auto meshid = 0; meshid < node->mNumMeshes; meshid++) {
+        numcorners += scene->GetScene ()->mMeshes[node->mMeshes[meshid]]->mNumFaces * 3;
+    }
+    VertexWelder<vertex_type> welder (split ? std::min<size_t> (numcorners / 4, 65536) : numcorners / 4);
+    std::vector<vertex_type> vertices;
+    std::vector<uint32_t> bases;
+    unsigned int chunks = 1;
+    std::vector<float> bboxes;
+    unsigned int texcoordsets = 0;
+    std::vector<unsigned int> lastuse;
+    std::vector<uint32_t> localindex;
+    double overshoot = 0;
+    bool wide = false;
+    std::vector<std::vector<uint32_t>> submeshes;
+    std::vector<uint32_t> indices;
+    std::vector<unsigned int> uniqueindices;
+
+    auto addSubmesh = [&] (unsigned int material) {
+        std::stringstream stream;
+        stream << "SUBMESH" << materials.size ();
+        /*
+         * The per-vertex state of the optimizations is sized to the vertices of the submesh rather than of
+         * the node: they work on the submesh renumbered to the vertices it references, in ascending order,
+         * so that the results are the same, and the optimized order is mapped back at the end.
+         */
+        std::vector<uint32_t> localvertices, local;
+        if (options.vertexcache || options.overdraw > 0) {
+            localvertices.assign (uniqueindices.begin (), uniqueindices.end ());
+            std::sort (localvertices.begin (), localvertices.end ());
+            if (localindex.size () < welder.GetVertices ().size ()) localindex.resize (welder.GetVertices ().size ());
+            for (auto i = 0; i < localvertices.size (); i++) localindex[localvertices[i]] = i;
+            local.resize (indices.size ());
+            for (auto i = 0; i < indices.size (); i++) local[i] = localindex[indices[i]];
         }
-        return false;
+        const unsigned int numvertices = localvertices.size ();
+        bool reordered = false;
+
+        if (options.vertexcache) {
+            ProfileScope profile ("vertex cache", name);
+            std::vector<uint32_t> optimized (local);
+            OptimizeVertexCache (optimized, numvertices, options.vertexcache);
+            VertexCacheStats before = AnalyzeVertexCache (local, numvertices, options.vertexcache);
+            VertexCacheStats after = AnalyzeVertexCache (optimized, numvertices, options.vertexcache);
+            /* on tiny or already optimal submeshes Tipsify can lose; keep the input order then */
+            if (after.acmr < before.acmr) {
+                local.swap (optimized);
+                reordered = true;
+            } else {
+                after = before;
+            }
+            report << name << ": " << stream.str () << " ACMR " << before.acmr << " -> " << after.acmr
+                   << ", ATVR " << before.atvr << " -> " << after.atvr << std::endl;
+        }
+        if (options.overdraw > 0 && !indices.empty ()) {
+            ProfileScope profile ("overdraw", name);
+            const unsigned int cachesize = options.vertexcache ? options.vertexcache : 16;
+            std::vector<float> positions;
+            positions.reserve (numvertices * 3);
+            for (auto index : localvertices) {
+                const float *position = welder.GetVertices ()[index].position ();
+                positions.insert (positions.end (), position, position + 3);
+            }
+            const size_t stride = sizeof (float) * 3;
+            std::vector<uint32_t> optimized (local);
+            OptimizeOverdraw (optimized, positions.data (), stride, numvertices, cachesize, options.overdraw);
+            double before = AnalyzeOverdraw (local, positions.data (), stride);
+            double after = AnalyzeOverdraw (optimized, positions.data (), stride);
+            double acmrbefore = AnalyzeVertexCache (local, numvertices, cachesize).acmr;
+            double acmrafter = AnalyzeVertexCache (optimized, numvertices, cachesize).acmr;
+            if (after < before) {
+                local.swap (optimized);
+                reordered = true;
+            } else {
+                after = before;
+                acmrafter = acmrbefore;
+            }
+            report << name << ": " << stream.str () << " overdraw " << before << " -> " << after
+                   << ", ACMR " << acmrbefore << " -> " << acmrafter << std::endl;
+        }
+        if (reordered) {
+            for (auto i = 0; i < local.size (); i++) indices[i] = localvertices[local[i]];
+        }
+        materials.push_back (material);
+        bases.push_back (vertices.size ());
+
+        ProfileScope profile ("bounding spheres", name);
+        std::vector<double> points;
+        points.reserve (uniqueindices.size () * 3);
+        for (auto index : uniqueindices) {
+            const float *position = welder.GetVertices ()[index].position ();
+            points.insert (points.end (), position, position + 3);
+        }
+        BoundingSphere sphere;
+        if (options.bspheres == Options::BSPHERES_FAST) {
+            double lowerbound;
+            sphere = FastBoundingSphere (points, lowerbound);
+            if (lowerbound > 0) {
+                overshoot = std::max (overshoot, sphere.radius / lowerbound - 1.0);
+            }
+        } else {
+            sphere = ExactBoundingSphere (points);
+        }
+        bboxes.push_back (scale * sphere.center[0]);
+        bboxes.push_back (scale * sphere.center[1]);
+        bboxes.push_back (scale * sphere.center[2]);
+        bboxes.push_back (scale * sphere.radius);
+
+        submeshes.push_back (std::move (indices));
+        indices.clear ();
+        uniqueindices.clear ();
+    };
+
+    ProfileScope welding ("welding", name);
+    for (auto _meshid = 0; _meshid < node->mNumMeshes; _meshid++) {
+        unsigned int meshid = submesh_order[_meshid];
+        const aiMesh *mesh = scene->GetScene ()->mMeshes[node->mMeshes[meshid]];
+        const unsigned int uvchannels = mesh->GetNumUVChannels ();
+        if (vertices.empty () && welder.GetVertices ().empty ()) {
+            texcoordsets = uvchannels;
+        }
+        if (options.positions == Options::POSITIONS_SUBMESH && !welder.GetVertices ().empty ()) {
+            /* a vertex can only be dequantized with one submesh's bounds, so don't share them */
+            welder.Flush (vertices);
+            chunks++;
+        }
+        indices.reserve (mesh->mNumFaces * 3);
+        for (auto faceid = 0; faceid < mesh->mNumFaces; faceid++) {
+            const aiFace &face = mesh->mFaces[faceid];
+            if (face.mNumIndices != 3) {
+                throw std::runtime_error ("not a triangle");
+            }
+            if (split && welder.GetVertices ().size () + 3 > 65536) {
+                /* the triangle might not fit into the chunk: continue the submesh in a new one */
+                if (!indices.empty ()) {
+                    addSubmesh (mesh->mMaterialIndex);
+                }
+                welder.Flush (vertices);
+                chunks++;
+            }
+            for (auto i = 0; i < 3; i++) {
+                unsigned int index = welder.Weld (vertex_type (mesh, uvchannels, face.mIndices[i]));
+                indices.push_back (index);
+
+                if (index >= lastuse.size ()) lastuse.resize (index + 1, 0);
+                if (lastuse[index] != materials.size () + 1) {
+                    lastuse[index] = materials.size () + 1;
+                    uniqueindices.push_back (index);
+                }
+            }
+        }
+        addSubmesh (mesh->mMaterialIndex);
+    }
+    welder.Flush (vertices);
+    welding.Stop ();
+
+    if (options.vertexfetch) {
+        ProfileScope profile ("vertex fetch", name);
+        /* submeshes only reference their own chunk, so first-use order keeps the chunks apart */
+        std::vector<uint32_t> stream;
+        for (auto i = 0; i < submeshes.size (); i++) {
+            for (auto index : submeshes[i]) stream.push_back (index + bases[i]);
+        }
+        const size_t vertexsize = sizeof (float) * 3;
+        double before = AnalyzeVertexFetch (stream, vertices.size (), vertexsize);
+        std::vector<uint32_t> remap = OptimizeVertexFetch (stream, vertices.size ());
+        for (auto &index : stream) index = remap[index];
+        double after = AnalyzeVertexFetch (stream, vertices.size (), vertexsize);
+
+        std::vector<uint32_t> order (vertices.size ());
+        for (auto i = 0; i < vertices.size (); i++) {
+            order[remap[i]] = i;
+        }
+        std::vector<vertex_type> reordered;
+        reordered.reserve (vertices.size ());
+        for (auto i : order) {
+            reordered.push_back (vertices[i]);
+        }
+        vertices.swap (reordered);
+        for (auto i = 0; i < submeshes.size (); i++) {
+            for (auto &index : submeshes[i]) index = remap[index + bases[i]] - bases[i];
+        }
+        report << name << ": vertex fetch overfetch " << before << " -> " << after << std::endl;
     }
-    float x;
-    float y;
-    float z;
-    float nx;
-    float ny;
-    float nz;
-    std::vector<float> tx;
-    std::vector<float> ty;
+
+    ProfileScope attributes ("attributes", name);
+    /*
+     * The index width follows the range of vertices a submesh uses: if counting from its lowest vertex
+     * allows a narrower type, that vertex becomes the submesh's base and its indices are made relative
+     * to it. Meshlets and levels of detail share the submesh's base.
+     */
+    const bool allow8bit = options.indices == Options::INDICES_ADAPTIVE;
+    std::vector<uint32_t> indexbases (bases);
+    bool rebased = false;
+    for (auto i = 0; i < submeshes.size (); i++) {
+        if (submeshes[i].empty ()) continue;
+        auto range = std::minmax_element (submeshes[i].begin (), submeshes[i].end ());
+        const uint32_t minindex = *range.first, maxindex = *range.second;
+        if (IndexBits (maxindex - minindex, allow8bit) < IndexBits (maxindex, allow8bit)) {
+            for (auto &index : submeshes[i]) index -= minindex;
+            indexbases[i] += minindex;
+            rebased = true;
+        }
+    }
+    for (auto i = 0; i < submeshes.size (); i++) {
+        std::stringstream stream;
+        stream << "SUBMESH" << i;
+        if (AddIndexSet (vf, stream.str (), submeshes[i], allow8bit) == 32) {
+            wide = true;
+        }
+    }
+
+    std::vector<uint32_t> ranges;
+    if (options.positions == Options::POSITIONS_SUBMESH) {
+        /* every submesh has a chunk of its own */
+        for (auto i = 0; i < bases.size (); i++) {
+            ranges.push_back (bases[i]);
+            ranges.push_back (i + 1 < bases.size () ? bases[i + 1] : vertices.size ());
+        }
+    } else {
+        ranges.push_back (0);
+        ranges.push_back (vertices.size ());
+    }
+    AddVertexSets (vertices, texcoordsets, ranges);
+    vf.AddSet ("BSPHERES", 4, VF_FLOAT, bboxes.size () / 4, bboxes.data ());
+    if (chunks > 1 || rebased) {
+        /* the vertex each submesh's indices count from, to be used as base vertex when drawing */
+        vf.AddSet ("SUBMESHBASES", 1, VF_UNSIGNED_INT, indexbases.size (), indexbases.data ());
+    }
+    if (split && chunks > 1) {
+        report << name << ": " << vertices.size () << " vertices, split into " << chunks
+               << " chunks with 16 bit indices" << std::endl;
+    }
+    if (wide) {
+        report << name << ": " << vertices.size () << " vertices, using 32 bit indices" << std::endl;
+    }
+    attributes.Stop ();
+    /* meshlet bounds and simplification work on the scaled float positions */
+    std::vector<float> positions;
+    if (options.meshletvertices || options.lods) {
+        positions.resize (vertices.size () * 3);
+        for (auto i = 0; i < vertices.size (); i++) {
+            for (auto c = 0; c < 3; c++) positions[i * 3 + c] = scale * vertices[i].position ()[c];
+        }
+    }
+    if (options.meshletvertices) {
+        ProfileScope profile ("meshlets", name);
+        for (auto i = 0; i < submeshes.size (); i++) {
+            AddMeshletSets (i, submeshes[i], positions.data () + indexbases[i] * 3, vertices.size () - indexbases[i]);
+        }
+    }
+    if (options.lods) {
+        ProfileScope profile ("lods", name);
+        AddLodSets (submeshes, indexbases, positions);
+    }
+
+    if (options.bspheres == Options::BSPHERES_FAST) {
+        report << name << ": bounding sphere radii exceed the optimum by at most "
+               << overshoot * 100.0 << "%" << std::endl;
+    }
+}
+
+/*
+ * Angle in radians between a normal and its decoded approximation, 0 for
+ * zero length normals.
+ */
+static double AngleBetween (const float *normal, const float *decoded) {
+    const double length = std::sqrt (double (normal[0]) * normal[0] + double (normal[1]) * normal[1]
+                                     + double (normal[2]) * normal[2]);
+    if (length == 0) return 0;
+    const double cross[3] = {
+        double (normal[1]) * decoded[2] - double (normal[2]) * decoded[1],
+        double (normal[2]) * decoded[0] - double (normal[0]) * decoded[2],
+        double (normal[0]) * decoded[1] - double (normal[1]) * decoded[0]
+    };
+    const double dot = double (normal[0]) * decoded[0] + double (normal[1]) * decoded[1]
+                       + double (normal[2]) * decoded[2];
+    return std::atan2 (std::sqrt (cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]), dot);
+}
+
+/*
+ * Storage of a vertex attribute: VF type, number of components and size
+ * in bytes, as selected in the options.
+ */
+struct AttributeFormat {
+    uint32_t type;
+    uint32_t components;
+    uint32_t size;
 };
 
+static AttributeFormat PositionFormat (const Options &options) {
+    if (options.positions == Options::POSITIONS_FLOAT) {
+        return AttributeFormat { VF_FLOAT, 3, 3 * sizeof (float) };
+    }
+    return AttributeFormat { VF_UNSIGNED_SHORT, 3, 3 * sizeof (uint16_t) };
+}
+
+static AttributeFormat NormalFormat (const Options &options) {
+    if (options.normalbits == 0) {
+        return AttributeFormat { VF_FLOAT, 3, 3 * sizeof (float) };
+    } else if (options.normalbits == 8) {
+        return AttributeFormat { VF_BYTE, 2, 2 * sizeof (int8_t) };
+    }
+    return AttributeFormat { VF_SHORT, 2, 2 * sizeof (int16_t) };
+}
+
+static AttributeFormat TexcoordFormat (const Options &options) {
+    if (options.texcoords == Options::TEXCOORDS_FLOAT) {
+        return AttributeFormat { VF_FLOAT, 2, 2 * sizeof (float) };
+    }
+    return AttributeFormat { VF_UNSIGNED_SHORT, 2, 2 * sizeof (uint16_t) };
+}
+
+/*
+ * Encoders of a single attribute value as given by the formats above. Each
+ * writes to target and raises error to the largest error seen so far;
+ * range is only used by 16 bit normalized formats.
+ */
+static void EncodePosition (const float position[3], const Options &options, const QuantizationRange &range,
+                            uint8_t *target, float &error) {
+    if (options.positions == Options::POSITIONS_FLOAT) {
+        memcpy (target, position, 3 * sizeof (float));
+        return;
+    }
+    uint16_t quantized[3];
+    for (auto c = 0; c < 3; c++) {
+        quantized[c] = QuantizeUnorm16 (position[c], range.offset[c], range.step[c]);
+        error = std::max (error, std::fabs (DequantizeUnorm16 (quantized[c], range.offset[c], range.step[c])
+                                            - position[c]));
+    }
+    memcpy (target, quantized, sizeof (quantized));
+}
+
+static void EncodeNormal (const float normal[3], const Options &options, uint8_t *target, double &error) {
+    if (options.normalbits == 0) {
+        memcpy (target, normal, 3 * sizeof (float));
+        return;
+    }
+    int32_t encoded[2];
+    float decoded[3];
+    OctahedralEncode (normal, options.normalbits, encoded);
+    OctahedralDecode (encoded, options.normalbits, decoded);
+    error = std::max (error, AngleBetween (normal, decoded));
+    if (options.normalbits == 8) {
+        const int8_t narrow[2] = { int8_t (encoded[0]), int8_t (encoded[1]) };
+        memcpy (target, narrow, sizeof (narrow));
+    } else {
+        const int16_t wide[2] = { int16_t (encoded[0]), int16_t (encoded[1]) };
+        memcpy (target, wide, sizeof (wide));
+    }
+}
+
+static void EncodeTexcoord (const float texcoord[2], const Options &options, const QuantizationRange &range,
+                            uint8_t *target, float &error) {
+    if (options.texcoords == Options::TEXCOORDS_FLOAT) {
+        memcpy (target, texcoord, 2 * sizeof (float));
+        return;
+    }
+    uint16_t quantized[2];
+    for (auto c = 0; c < 2; c++) {
+        if (options.texcoords == Options::TEXCOORDS_UNORM16) {
+            quantized[c] = QuantizeUnorm16 (texcoord[c], range.offset[c], range.step[c]);
+            error = std::max (error, std::fabs (DequantizeUnorm16 (quantized[c], range.offset[c], range.step[c])
+                                                - texcoord[c]));
+        } else {
+            quantized[c] = FloatToHalf (texcoord[c]);
+            error = std::max (error, std::fabs (HalfToFloat (quantized[c]) - texcoord[c]));
+        }
+    }
+    memcpy (target, quantized, sizeof (quantized));
+}
+
+/* adds a set of one of the attribute formats above, stored as bytes */
+static void AddAttributeSet (VF &vf, const std::string &name, const AttributeFormat &format, size_t count,
+                             const uint8_t *data) {
+    switch (format.type) {
+        case VF_FLOAT:
+            vf.AddSet (name, format.components, VF_FLOAT, count, reinterpret_cast<const float*> (data));
+            break;
+        case VF_UNSIGNED_SHORT:
+            vf.AddSet (name, format.components, VF_UNSIGNED_SHORT, count, reinterpret_cast<const uint16_t*> (data));
+            break;
+        case VF_SHORT:
+            vf.AddSet (name, format.components, VF_SHORT, count, reinterpret_cast<const int16_t*> (data));
+            break;
+        default:
+            vf.AddSet (name, format.components, VF_BYTE, count, reinterpret_cast<const int8_t*> (data));
+            break;
+    }
+}
+
+/*
+ * Adds the vertex attributes, encoded as selected in the options, either
+ * as POSITIONS, NORMALS (if the vertices have normals) and TEXCOORDS<n>,
+ * or with --interleave as a single VERTICES set of unsigned bytes, one
+ * element per vertex, with as many components as a vertex has bytes. There
+ * every attribute starts at a multiple of four bytes, and VERTEXLAYOUT
+ * describes one attribute per element (unsigned int): the attribute (0
+ * position, 1 normal, 2 + n texture coordinate set n), its byte offset, its
+ * VF type and its number of components.
+ *
+ * Positions are scaled and quantized relative to the bounds of each vertex
+ * range [ranges[2i], ranges[2i+1]). The QUANTIZATION set holds pairs of
+ * rows (offset, step), each three floats, first for every position range,
+ * then for every texture coordinate set if those are quantized to 16 bit
+ * normalized values; a value q decodes to offset + q * step.
+ *
+ * After the bounds are found, a single pass over the welded vertices
+ * encodes every attribute straight into the output buffers.
+ */
+template<unsigned int NumUVChannels, bool HasNormals>
+void Node::AddVertexSets (const std::vector<Vertex<NumUVChannels, HasNormals>> &vertices, unsigned int texcoordsets,
+                          const std::vector<uint32_t> &ranges) {
+    typedef Vertex<NumUVChannels, HasNormals> vertex_type;
+    const Options &options = scene->GetOptions ();
+    const size_t numvertices = vertices.size ();
+    const float scale = options.scale;
+
+    std::vector<QuantizationRange> positionranges (ranges.size () / 2), texcoordranges (texcoordsets);
+    const bool unormpositions = options.positions != Options::POSITIONS_FLOAT;
+    const bool unormtexcoords = options.texcoords == Options::TEXCOORDS_UNORM16;
+    std::vector<float> quantization;
+    if (unormpositions) {
+        for (auto r = 0; r < positionranges.size (); r++) {
+            const size_t begin = ranges[r * 2], end = ranges[r * 2 + 1];
+            if (begin < end) {
+                positionranges[r] = ComputeQuantizationRange (vertices[begin].position (), end - begin, 3,
+                                                              vertex_type::NumFloats, scale);
+            }
+            quantization.insert (quantization.end (), positionranges[r].offset, positionranges[r].offset + 3);
+            quantization.insert (quantization.end (), positionranges[r].step, positionranges[r].step + 3);
+        }
+    }
+    if (unormtexcoords) {
+        for (auto j = 0; j < texcoordsets; j++) {
+            if (numvertices > 0) {
+                texcoordranges[j] = ComputeQuantizationRange (vertices[0].texcoord (j), numvertices, 2,
+                                                              vertex_type::NumFloats, 1.0f);
+            }
+            quantization.insert (quantization.end (), texcoordranges[j].offset, texcoordranges[j].offset + 3);
+            quantization.insert (quantization.end (), texcoordranges[j].step, texcoordranges[j].step + 3);
+        }
+    }
+
+    /* attribute k is written to targets[k] + i * strides[k] for vertex i */
+    std::vector<AttributeFormat> formats;
+    std::vector<uint32_t> attributes;
+    formats.push_back (PositionFormat (options));
+    attributes.push_back (0);
+    if (HasNormals) {
+        formats.push_back (NormalFormat (options));
+        attributes.push_back (1);
+    }
+    for (auto j = 0; j < texcoordsets; j++) {
+        formats.push_back (TexcoordFormat (options));
+        attributes.push_back (2 + j);
+    }
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<uint8_t*> targets;
+    std::vector<size_t> strides;
+    std::vector<uint32_t> layout;
+    uint32_t stride = 0;
+    if (options.interleave) {
+        for (auto k = 0; k < formats.size (); k++) {
+            layout.insert (layout.end (), { attributes[k], stride, formats[k].type, formats[k].components });
+            stride += (formats[k].size + 3) & ~3u;
+        }
+        buffers.emplace_back (numvertices * stride);
+        for (auto k = 0; k < formats.size (); k++) {
+            targets.push_back (buffers[0].data () + layout[k * 4 + 1]);
+            strides.push_back (stride);
+        }
+    } else {
+        for (auto &format : formats) {
+            buffers.emplace_back (numvertices * format.size);
+            targets.push_back (buffers.back ().data ());
+            strides.push_back (format.size);
+        }
+    }
+
+    float positionerror = 0, texcoorderror = 0;
+    double normalerror = 0;
+    size_t r = 0;
+    for (size_t i = 0; i < numvertices; i++) {
+        const vertex_type &v = vertices[i];
+        const float position[3] = { scale * v.position ()[0], scale * v.position ()[1], scale * v.position ()[2] };
+        while (unormpositions && i >= ranges[r * 2 + 1]) r++;
+        EncodePosition (position, options, positionranges[r], targets[0] + i * strides[0], positionerror);
+        unsigned int k = 1;
+        if (HasNormals) {
+            EncodeNormal (v.normal (), options, targets[k] + i * strides[k], normalerror);
+            k++;
+        }
+        for (auto j = 0; j < texcoordsets; j++, k++) {
+            EncodeTexcoord (v.texcoord (j), options, texcoordranges[j], targets[k] + i * strides[k], texcoorderror);
+        }
+    }
+
+    size_t bytes = 0, floatbytes = 0;
+    if (options.interleave) {
+        vf.AddSet ("VERTICES", stride, VF_UNSIGNED_BYTE, numvertices, buffers[0].data ());
+        vf.AddSet ("VERTEXLAYOUT", 4, VF_UNSIGNED_INT, layout.size () / 4, layout.data ());
+    } else {
+        unsigned int k = 0;
+        AddAttributeSet (vf, "POSITIONS", formats[k], numvertices, buffers[k].data ());
+        k++;
+        if (HasNormals) {
+            AddAttributeSet (vf, "NORMALS", formats[k], numvertices, buffers[k].data ());
+            k++;
+        }
+        for (auto j = 0; j < texcoordsets; j++, k++) {
+            std::stringstream stream;
+            stream << "TEXCOORDS" << j;
+            AddAttributeSet (vf, stream.str (), formats[k], numvertices, buffers[k].data ());
+        }
+        for (auto &format : formats) bytes += format.size;
+        floatbytes = (HasNormals ? 6 : 3) * sizeof (float) + texcoordsets * 2 * sizeof (float);
+    }
+    if (!quantization.empty ()) {
+        vf.AddSet ("QUANTIZATION", 3, VF_FLOAT, quantization.size () / 3, quantization.data ());
+    }
+
+    if (numvertices == 0) return;
+    std::ostringstream errors;
+    if (unormpositions) errors << ", positions " << positionerror;
+    if (HasNormals && options.normalbits) errors << ", normals " << normalerror * 180.0 / 3.14159265358979323846 << " degrees";
+    if (options.texcoords != Options::TEXCOORDS_FLOAT && texcoordsets > 0) errors << ", texcoords " << texcoorderror;
+    if (options.interleave) {
+        report << name << ": interleaved " << stride << " bytes per vertex";
+        if (!errors.str ().empty ()) report << ", maximum error" << errors.str ().substr (1);
+        report << std::endl;
+    } else if (bytes != floatbytes) {
+        report << name << ": " << double (bytes) << " bytes per vertex instead of " << double (floatbytes)
+               << ", maximum error" << errors.str ().substr (1) << std::endl;
+    }
+}
+
+/*
+ * Partitions the triangles of SUBMESH<submesh> into meshlets and adds
+ *   SUBMESH<n>_MESHLETS: vertex offset, vertex count, triangle offset and
+ *     triangle count of each meshlet (unsigned int),
+ *   SUBMESH<n>_MESHLETVERTICES: the vertex indices used by the meshlets,
+ *     relative to the same base as the submesh indices (unsigned int),
+ *   SUBMESH<n>_MESHLETTRIANGLES: triangles as indices into the meshlet's
+ *     vertices (unsigned byte),
+ *   SUBMESH<n>_MESHLETBOUNDS: bounding sphere center and radius, normal
+ *     cone axis and cutoff of each meshlet (float).
+ */
+void Node::AddMeshletSets (unsigned int submesh, const std::vector<uint32_t> &indices, const float *positions,
+                           size_t numvertices) {
+    const Options &options = scene->GetOptions ();
+    Meshlets meshlets = BuildMeshlets (indices, numvertices, options.meshletvertices, options.meshlettriangles);
+    std::vector<uint32_t> ranges;
+    std::vector<float> bounds;
+    ranges.reserve (meshlets.meshlets.size () * 4);
+    bounds.reserve (meshlets.meshlets.size () * 8);
+    for (auto &meshlet : meshlets.meshlets) {
+        ranges.push_back (meshlet.vertexoffset);
+        ranges.push_back (meshlet.vertexcount);
+        ranges.push_back (meshlet.triangleoffset);
+        ranges.push_back (meshlet.trianglecount);
+        MeshletBounds b = ComputeMeshletBounds (meshlets, meshlet, positions);
+        bounds.insert (bounds.end (), b.center, b.center + 3);
+        bounds.push_back (b.radius);
+        bounds.insert (bounds.end (), b.axis, b.axis + 3);
+        bounds.push_back (b.cutoff);
+    }
+
+    std::stringstream prefix;
+    prefix << "SUBMESH" << submesh << "_MESHLET";
+    vf.AddSet (prefix.str () + "S", 4, VF_UNSIGNED_INT, meshlets.meshlets.size (), ranges.data ());
+    vf.AddSet (prefix.str () + "VERTICES", 1, VF_UNSIGNED_INT, meshlets.vertices.size (), meshlets.vertices.data ());
+    vf.AddSet (prefix.str () + "TRIANGLES", 3, VF_UNSIGNED_BYTE, meshlets.triangles.size () / 3, meshlets.triangles.data ());
+    vf.AddSet (prefix.str () + "BOUNDS", 8, VF_FLOAT, meshlets.meshlets.size (), bounds.data ());
+
+    if (!meshlets.meshlets.empty ()) {
+        report << name << ": SUBMESH" << submesh << " " << meshlets.meshlets.size () << " meshlets, "
+               << double (meshlets.vertices.size ()) / meshlets.meshlets.size () << " vertices and "
+               << double (indices.size () / 3) / meshlets.meshlets.size () << " triangles on average" << std::endl;
+    }
+}
+
+/*
+ * Adds SUBMESH<n>_LOD<k> for k = 1 ... options.lods, each simplified from
+ * the previous level, over the same vertices and base as SUBMESH<n>, and
+ * SUBMESH<n>_LODERRORS with the geometric error of every level (float, in
+ * output units). Vertices on UV or normal seams, on material boundaries
+ * and on open borders stay in place, so levels of neighbouring submeshes
+ * still fit together. Simplification stops early rather than exceed an
+ * error of options.lodmaxerror (the third value of --lods) times the
+ * submesh's extent.
+ */
+void Node::AddLodSets (const std::vector<std::vector<uint32_t>> &submeshes, const std::vector<uint32_t> &bases,
+                       const std::vector<float> &positions) {
+    const Options &options = scene->GetOptions ();
+    const size_t numvertices = positions.size () / 3;
+
+    /* vertices sharing a position form a group */
+    std::vector<uint32_t> group (numvertices);
+    {
+        std::vector<uint32_t> order (numvertices);
+        for (auto i = 0; i < numvertices; i++) order[i] = i;
+        auto less = [&] (uint32_t a, uint32_t b) {
+            return std::lexicographical_compare (&positions[a * 3], &positions[a * 3 + 3],
+                                                 &positions[b * 3], &positions[b * 3 + 3]);
+        };
+        std::sort (order.begin (), order.end (), less);
+        for (auto i = 0; i < numvertices; i++) {
+            group[order[i]] = (i > 0 && !less (order[i - 1], order[i])) ? group[order[i - 1]] : order[i];
+        }
+    }
+    std::vector<uint8_t> lockedgroup (numvertices);
+    std::vector<uint32_t> groupsize (numvertices);
+    for (auto i = 0; i < numvertices; i++) {
+        if (++groupsize[group[i]] > 1) lockedgroup[group[i]] = 1;
+    }
+    std::vector<uint32_t> owner (numvertices, uint32_t (-1));
+    std::vector<uint64_t> edges;
+    for (auto i = 0; i < submeshes.size (); i++) {
+        edges.clear ();
+        for (auto t = 0; t + 2 < submeshes[i].size (); t += 3) {
+            for (auto j = 0; j < 3; j++) {
+                const uint32_t a = group[submeshes[i][t + j] + bases[i]];
+                const uint32_t b = group[submeshes[i][t + (j + 1) % 3] + bases[i]];
+                if (owner[a] != i) lockedgroup[a] |= owner[a] != uint32_t (-1);
+                owner[a] = i;
+                edges.push_back ((uint64_t (std::min (a, b)) << 32) | std::max (a, b));
+            }
+        }
+        /* edges used by a single triangle lie on an open border */
+        std::sort (edges.begin (), edges.end ());
+        for (auto e = 0; e < edges.size (); e++) {
+            if ((e == 0 || edges[e - 1] != edges[e]) && (e + 1 == edges.size () || edges[e + 1] != edges[e])) {
+                lockedgroup[edges[e] >> 32] = 1;
+                lockedgroup[edges[e] & 0xFFFFFFFF] = 1;
+            }
+        }
+    }
+    std::vector<uint8_t> locked (numvertices);
+    for (auto i = 0; i < numvertices; i++) locked[i] = lockedgroup[group[i]];
+
+    for (auto i = 0; i < submeshes.size (); i++) {
+        std::vector<uint32_t> indices (submeshes[i]);
+        std::vector<float> errors;
+        float lower[3] = { HUGE_VALF, HUGE_VALF, HUGE_VALF }, upper[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+        for (auto index : indices) {
+            for (auto c = 0; c < 3; c++) {
+                lower[c] = std::min (lower[c], positions[(index + bases[i]) * 3 + c]);
+                upper[c] = std::max (upper[c], positions[(index + bases[i]) * 3 + c]);
+            }
+        }
+        const float maxerror = options.lodmaxerror * std::max ({ upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2], 0.0f });
+        float error = 0.0f;
+        for (auto level = 1; level <= options.lods; level++) {
+            const size_t target = size_t (submeshes[i].size () / 3 * std::pow (options.lodratio, level));
+            float levelerror;
+            indices = SimplifyMesh (indices, &positions[bases[i] * 3], numvertices - bases[i],
+                                    &locked[bases[i]], target, maxerror, levelerror);
+            error = std::max (error, levelerror);
+            errors.push_back (error);
+
+            std::stringstream stream;
+            stream << "SUBMESH" << i << "_LOD" << level;
+            AddIndexSet (vf, stream.str (), indices, options.indices == Options::INDICES_ADAPTIVE);
+            report << name << ": " << stream.str () << " " << indices.size () / 3 << " of "
+                   << submeshes[i].size () / 3 << " triangles, error " << error << std::endl;
+        }
+        std::stringstream stream;
+        stream << "SUBMESH" << i << "_LODERRORS";
+        vf.AddSet (stream.str (), 1, VF_FLOAT, errors.size (), errors.data ());
+    }
+}
+
+std::vector<unsigned int> SubmeshOrder (const aiScene *scene, const aiNode *node) {
+    std::vector<unsigned int> submesh_order;
+    for (auto meshid = 0; meshid < node->mNumMeshes; meshid++) {
+        submesh_order.push_back (meshid);
+    }
+
+    std::sort (submesh_order.begin (), submesh_order.end (), [&] (unsigned int lhs, unsigned int rhs) -> bool {
+        aiString _lhs_name;
+        aiString _rhs_name;
+        scene->mMaterials[scene->mMeshes[node->mMeshes[lhs]]->mMaterialIndex]->Get (AI_MATKEY_NAME, _lhs_name);
+        scene->mMaterials[scene->mMeshes[node->mMeshes[rhs]]->mMaterialIndex]->Get (AI_MATKEY_NAME, _rhs_name);
+        std::string lhs_name (_lhs_name.data, _lhs_name.length);
+        std::string rhs_name (_rhs_name.data, _rhs_name.length);
+        if (!lhs_name.compare (0, 9, "Material-"))
+            lhs_name.erase (0, 9);
+        if (!rhs_name.compare (0, 9, "Material-"))
+            rhs_name.erase (0, 9);
+
+        for (auto i = 0; i < lhs_name.length (); i++) {
+            if (rhs_name.length () <= i) return true;
+            else if (std::toupper (lhs_name[i]) < std::toupper (rhs_name[i])) return true;
+            else if (std::toupper (lhs_name[i]) > std::toupper (rhs_name[i])) return false;
+        }
+        return false;
+    });
+    return submesh_order;
+}
+
 void Node::Load (const aiNode *node) {
     name = std::string (node->mName.data, node->mName.length);
     for (auto &c : name) if (c == '.' || c == ' ' || c == '-') c = '_';
@@ -88,6 +784,7 @@ void Node::Load (const aiNode *node) {
         for (auto &c : parent) if (c == '.' || c == ' ' || c == '-') c = '_';
     }
     node->mTransformation.Decompose (scaling, rotation, position);
+    ProfileScope profile ("node", name);
 
     if (node->mNumMeshes > 0) {
         if (!name.compare (0, 12, "meloadCurve_")) {
@@ -102,126 +799,44 @@ void Node::Load (const aiNode *node) {
     }
 
     if (type == Mesh) {
-        std::vector<unsigned int> submesh_order;
-        for (auto meshid = 0; meshid < node->mNumMeshes; meshid++) {
-            submesh_order.push_back (meshid);
-        }
-
-        std::sort (submesh_order.begin (), submesh_order.end (), [&] (unsigned int lhs, unsigned int rhs) -> bool {
-            aiString _lhs_name;
-            aiString _rhs_name;
-            scene->GetScene ()->mMaterials[scene->GetScene ()->mMeshes[node->mMeshes[lhs]]->mMaterialIndex]->Get (AI_MATKEY_NAME, _lhs_name);
-            scene->GetScene ()->mMaterials[scene->GetScene ()->mMeshes[node->mMeshes[rhs]]->mMaterialIndex]->Get (AI_MATKEY_NAME, _rhs_name);
-            std::string lhs_name (_lhs_name.data, _lhs_name.length);
-            std::string rhs_name (_rhs_name.data, _rhs_name.length);
-            if (!lhs_name.compare (0, 9, "Material-"))
-                lhs_name.erase (0, 9);
-            if (!rhs_name.compare (0, 9, "Material-"))
-                rhs_name.erase (0, 9);
-
-            for (auto i = 0; i < lhs_name.length (); i++) {
-                if (rhs_name.length () <= i) return true;
-                else if (std::toupper (lhs_name[i]) < std::toupper (rhs_name[i])) return true;
-                else if (std::toupper (lhs_name[i]) > std::toupper (rhs_name[i])) return false;
-            }
-            return false;
-        });
-
-        std::map<Vertex, unsigned int> vertexmap;
-        std::vector<Vertex> vertices;
-        std::vector<float> bboxes;
+        ProfileScope sort ("submesh sort", name);
+        const std::vector<unsigned int> submesh_order (SubmeshOrder (scene->GetScene (), node));
+        sort.Stop ();
 
-        for (auto _meshid = 0; _meshid < node->mNumMeshes; _meshid++) {
-            unsigned int meshid = submesh_order[_meshid];
-            std::vector<uint16_t> indices;
-            std::vector<Seb::Point<double>> sebpoints;
+        unsigned int uvchannels = 0;
+        bool normals = false;
+        for (auto meshid = 0; meshid < node->mNumMeshes; meshid++) {
             const aiMesh *mesh = scene->GetScene ()->mMeshes[node->mMeshes[meshid]];
-            materials.push_back (mesh->mMaterialIndex);
-            for (auto faceid = 0; faceid < mesh->mNumFaces; faceid++) {
-                const aiFace &face = mesh->mFaces[faceid];
-                if (face.mNumIndices != 3) {
-                    throw std::runtime_error ("not a triangle");
-                }
-                for (auto i = 0; i < 3; i++) {
-                    unsigned int index = face.mIndices[i];
-                    std::vector<aiVector3D> texcoords;
-                    for (auto j = 0; j < mesh->GetNumUVChannels (); j++) {
-                        texcoords.push_back (mesh->mTextureCoords[j][index]);
-                    }
-                    Vertex v (mesh->mVertices[index], mesh->mNormals[index], texcoords);
-
-                    const double coords[] = { v.x, v.y, v.z };
-                    sebpoints.emplace_back (3, coords);
-
-                    auto it = vertexmap.find (v);
-                    if (it == vertexmap.end ()) {
-                        index = vertices.size ();
-                        vertexmap[v] = index;
-                        vertices.push_back (v);
-                    } else {
-                        index = it->second;
-                    }
-                    if (index > 65535) throw std::runtime_error ("index too large");
-                    indices.push_back (index);
-                }
-            }
-
-            {
-                std::stringstream stream;
-                stream << "SUBMESH" << _meshid;
-                vfAddSet (vf, stream.str ().c_str (), 3, VF_UNSIGNED_SHORT, indices.size () / 3, indices.data (), 0);
-
-                Seb::Smallest_enclosing_ball<double> miniball (3, sebpoints);
-                bboxes.push_back (Arguments::get ().scale () * *(miniball.center_begin () + 0));
-                bboxes.push_back (Arguments::get ().scale () * *(miniball.center_begin () + 1));
-                bboxes.push_back (Arguments::get ().scale () * *(miniball.center_begin () + 2));
-                bboxes.push_back (Arguments::get ().scale () * miniball.radius ());
-            }
+            uvchannels = std::max (uvchannels, mesh->GetNumUVChannels ());
+            normals = normals || mesh->HasNormals ();
         }
 
-        {
-            std::vector<float> positions;
-            positions.resize (vertices.size () * 3);
-            for (auto i = 0; i < vertices.size (); i++) {
-                positions[i*3+0] = Arguments::get ().scale () * vertices[i].x;
-                positions[i*3+1] = Arguments::get ().scale () * vertices[i].y;
-                positions[i*3+2] = Arguments::get ().scale () * vertices[i].z;
-            }
-            vfAddSet (vf, "POSITIONS", 3, VF_FLOAT, vertices.size (), positions.data (), 0);
-        }
-        {
-            std::vector<float> normals;
-            normals.resize (vertices.size () * 3);
-            for (auto i = 0; i < vertices.size (); i++) {
-                normals[i * 3 + 0] = vertices[i].nx;
-                normals[i * 3 + 1] = vertices[i].ny;
-                normals[i * 3 + 2] = vertices[i].nz;
-            }
-            vfAddSet (vf, "NORMALS", 3, VF_FLOAT, vertices.size (), normals.data (), 0);
-        }
-        for (auto i = 0; i < vertices.front ().tx.size (); i++)
-        {
-            std::vector<float> texcoords;
-            texcoords.resize (vertices.size () * 2);
-            for (auto j = 0; j < vertices.size (); j++) {
-                texcoords[j*2+0] = vertices[j].tx[i];
-                texcoords[j*2+1] = vertices[j].ty[i];
-            }
-            std::stringstream stream;
-            stream << "TEXCOORDS" << i;
-            vfAddSet (vf, stream.str ().c_str (), 2, VF_FLOAT, vertices.size (), texcoords.data (), 0);
+        static_assert (AI_MAX_NUMBER_OF_TEXTURECOORDS <= 8, "unsupported number of texture coordinate channels");
+        switch (uvchannels) {
+            case 0: normals ? LoadMesh<0, true> (node, submesh_order) : LoadMesh<0, false> (node, submesh_order); break;
+            case 1: normals ? LoadMesh<1, true> (node, submesh_order) : LoadMesh<1, false> (node, submesh_order); break;
+            case 2: normals ? LoadMesh<2, true> (node, submesh_order) : LoadMesh<2, false> (node, submesh_order); break;
+            case 3: normals ? LoadMesh<3, true> (node, submesh_order) : LoadMesh<3, false> (node, submesh_order); break;
+            case 4: normals ? LoadMesh<4, true> (node, submesh_order) : LoadMesh<4, false> (node, submesh_order); break;
+            case 5: normals ? LoadMesh<5, true> (node, submesh_order) : LoadMesh<5, false> (node, submesh_order); break;
+            case 6: normals ? LoadMesh<6, true> (node, submesh_order) : LoadMesh<6, false> (node, submesh_order); break;
+            case 7: normals ? LoadMesh<7, true> (node, submesh_order) : LoadMesh<7, false> (node, submesh_order); break;
+            case 8: normals ? LoadMesh<8, true> (node, submesh_order) : LoadMesh<8, false> (node, submesh_order); break;
+            default:
+                throw std::runtime_error ("too many texture coordinate channels");
         }
-        vfAddSet (vf, "BSPHERES", 4, VF_FLOAT, bboxes.size () / 4, bboxes.data (), 0);
     } else if (type == SplineCurve || type == BezierCurve) {
         if (node->mNumMeshes != 1) throw std::runtime_error ("more than one mesh in curve");
         const aiMesh *mesh = scene->GetScene ()->mMeshes[node->mMeshes[0]];
+        const float scale = scene->GetOptions ().scale;
         std::vector<float> positions;
         positions.resize (mesh->mNumVertices * 3);
         for (auto i = 0; i < mesh->mNumVertices; i++) {
-            positions[i * 3 + 0] = Arguments::get ().scale () * mesh->mVertices[i].x;
-            positions[i * 3 + 1] = Arguments::get ().scale () * mesh->mVertices[i].y;
-            positions[i * 3 + 2] = Arguments::get ().scale () * mesh->mVertices[i].z;
+            positions[i * 3 + 0] = scale * mesh->mVertices[i].x;
+            positions[i * 3 + 1] = scale * mesh->mVertices[i].y;
+            positions[i * 3 + 2] = scale * mesh->mVertices[i].z;
         }
-        vfAddSet (vf, "POSITIONS", 3, VF_FLOAT, mesh->mNumVertices, positions.data (), 0);
+        vf.AddSet ("POSITIONS", 3, VF_FLOAT, mesh->mNumVertices, positions.data ());
     }
+    output = !vf.IsEmpty ();
 }
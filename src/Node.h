@@ -21,10 +21,19 @@
 #define ASSIMP2VF_NODE_H
 
 #include <assimp/scene.h>
+#include <sstream>
 #include <vector>
-#include <openvf/openvf.h>
+#include "VF.h"
 
 class Scene;
+template<unsigned int NumUVChannels, bool HasNormals>
+struct Vertex;
+
+/*
+ * Order in which the meshes of a node are stored as submeshes: sorted by
+ * material name, ignoring case and a "Material-" prefix.
+ */
+std::vector<unsigned int> SubmeshOrder (const aiScene *scene, const aiNode *node);
 
 class Node {
 public:
@@ -46,12 +55,16 @@ public:
     const aiQuaternion &GetRotation (void) const {
         return rotation;
     }
-    vf_t *GetVF (void) {
+    VF &GetVF (void) {
         return vf;
     }
-    const vf_t *GetVF (void) const {
+    const VF &GetVF (void) const {
         return vf;
     }
+    /* whether Load () produced a file to write, even if the VF has been freed since */
+    bool HasOutput (void) const {
+        return output;
+    }
     enum Type {
         Container,
         Mesh,
@@ -78,8 +91,24 @@ public:
     const std::vector<unsigned int> &GetMaterials (void) const {
         return materials;
     }
+    /*
+     * Statistics gathered during Load (), printed by the Scene in node order.
+     */
+    std::string GetReport (void) const {
+        return report.str ();
+    }
 private:
-    vf_t *vf;
+    template<unsigned int NumUVChannels, bool HasNormals>
+    void LoadMesh (const aiNode *node, const std::vector<unsigned int> &submesh_order);
+    template<unsigned int NumUVChannels, bool HasNormals>
+    void AddVertexSets (const std::vector<Vertex<NumUVChannels, HasNormals>> &vertices, unsigned int texcoordsets,
+                        const std::vector<uint32_t> &ranges);
+    void AddMeshletSets (unsigned int submesh, const std::vector<uint32_t> &indices, const float *positions,
+                         size_t numvertices);
+    void AddLodSets (const std::vector<std::vector<uint32_t>> &submeshes, const std::vector<uint32_t> &bases,
+                     const std::vector<float> &positions);
+    VF vf;
+    bool output;
     Type type;
     std::string name;
     std::string parent;
@@ -87,6 +116,7 @@ private:
     aiVector3D scaling;
     aiQuaternion rotation;
     std::vector<unsigned int> materials;
+    std::ostringstream report;
     Scene *scene;
 };
 
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Overdraw.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "VertexCache.h"
+
+namespace {
+
+const float *Position (const float *positions, size_t stride, uint32_t index) {
+    return reinterpret_cast<const float*> (reinterpret_cast<const char*> (positions) + index * stride);
+}
+
+void Cross (const float *a, const float *b, const float *c, float *n) {
+    const float u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const float v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+/*
+ * Rasterizes orthographically, seen from the direction of axis, counting
+ * shaded and covered pixels.
+ */
+void Rasterize (const std::vector<uint32_t> &indices, const float *positions, size_t stride,
+                const float axis[3], size_t &shaded, size_t &covered) {
+    enum { Resolution = 256 };
+    /* orthonormal basis with the view direction as third axis */
+    float right[3], up[3];
+    {
+        const float helper[3] = { std::fabs (axis[0]) < 0.9f ? 1.0f : 0.0f, std::fabs (axis[0]) < 0.9f ? 0.0f : 1.0f, 0.0f };
+        const float zero[3] = { 0, 0, 0 };
+        Cross (zero, axis, helper, right);
+        float length = std::sqrt (right[0] * right[0] + right[1] * right[1] + right[2] * right[2]);
+        for (auto &r : right) r /= length;
+        Cross (zero, axis, right, up);
+    }
+
+    std::vector<float> projected (indices.size () * 3);
+    float minimum[2] = { std::numeric_limits<float>::max (), std::numeric_limits<float>::max () };
+    float maximum[2] = { -std::numeric_limits<float>::max (), -std::numeric_limits<float>::max () };
+    for (size_t i = 0; i < indices.size (); i++) {
+        const float *p = Position (positions, stride, indices[i]);
+        float *q = &projected[i * 3];
+        q[0] = p[0] * right[0] + p[1] * right[1] + p[2] * right[2];
+        q[1] = p[0] * up[0] + p[1] * up[1] + p[2] * up[2];
+        q[2] = -(p[0] * axis[0] + p[1] * axis[1] + p[2] * axis[2]);
+        for (auto c = 0; c < 2; c++) {
+            minimum[c] = std::min (minimum[c], q[c]);
+            maximum[c] = std::max (maximum[c], q[c]);
+        }
+    }
+    const float extent = std::max (maximum[0] - minimum[0], maximum[1] - minimum[1]);
+    if (!(extent > 0)) return;
+    const float scale = (Resolution - 1) / extent;
+    for (size_t i = 0; i < projected.size (); i += 3) {
+        projected[i + 0] = (projected[i + 0] - minimum[0]) * scale;
+        projected[i + 1] = (projected[i + 1] - minimum[1]) * scale;
+    }
+
+    std::vector<float> depth (Resolution * Resolution, std::numeric_limits<float>::max ());
+    std::vector<uint32_t> count (Resolution * Resolution, 0);
+    for (size_t t = 0; t < projected.size (); t += 9) {
+        const float *a = &projected[t], *b = &projected[t + 3], *c = &projected[t + 6];
+        const float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+        /* counterclockwise is front facing */
+        if (!(area > 0)) continue;
+        const int x0 = std::max (0, int (std::ceil (std::min ({ a[0], b[0], c[0] }))));
+        const int x1 = std::min (Resolution - 1, int (std::floor (std::max ({ a[0], b[0], c[0] }))));
+        const int y0 = std::max (0, int (std::ceil (std::min ({ a[1], b[1], c[1] }))));
+        const int y1 = std::min (Resolution - 1, int (std::floor (std::max ({ a[1], b[1], c[1] }))));
+        for (auto y = y0; y <= y1; y++) {
+            for (auto x = x0; x <= x1; x++) {
+                const float w0 = (c[0] - b[0]) * (y - b[1]) - (c[1] - b[1]) * (x - b[0]);
+                const float w1 = (a[0] - c[0]) * (y - c[1]) - (a[1] - c[1]) * (x - c[0]);
+                const float w2 = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+                if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+                const float z = (w0 * a[2] + w1 * b[2] + w2 * c[2]) / area;
+                const int pixel = y * Resolution + x;
+                if (z < depth[pixel]) {
+                    depth[pixel] = z;
+                    if (count[pixel]++ == 0) covered++;
+                    shaded++;
+                }
+            }
+        }
+    }
+}
+
+}
+
+double AnalyzeOverdraw (const std::vector<uint32_t> &indices, const float *positions, size_t stride) {
+    static const float views[][3] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+        { 0.57735f, 0.57735f, 0.57735f }, { -0.57735f, -0.57735f, -0.57735f },
+        { 0.57735f, -0.57735f, 0.57735f }, { -0.57735f, 0.57735f, -0.57735f }
+    };
+    size_t shaded = 0, covered = 0;
+    for (auto &view : views) {
+        Rasterize (indices, positions, stride, view, shaded, covered);
+    }
+    return covered ? double (shaded) / covered : 0.0;
+}
+
+namespace {
+
+/*
+ * Triangle offsets at which clusters start, plus numtriangles at the end:
+ * the list is cut wherever the current cluster, simulated with a cold
+ * cache, has at most target misses per triangle.
+ */
+std::vector<size_t> Clusters (const std::vector<uint32_t> &indices, unsigned int numvertices,
+                              unsigned int cachesize, double target) {
+    enum { MinClusterSize = 8 };
+    const size_t numtriangles = indices.size () / 3;
+    std::vector<size_t> clusters (1, 0);
+    std::vector<uint32_t> inserted (numvertices, 0);
+    uint32_t time = cachesize + 1;
+    size_t misses = 0;
+    for (size_t t = 0; t < numtriangles; t++) {
+        for (auto i = 0; i < 3; i++) {
+            const uint32_t v = indices[t * 3 + i];
+            if (time - inserted[v] > cachesize) {
+                inserted[v] = time++;
+                misses++;
+            }
+        }
+        const size_t size = t + 1 - clusters.back ();
+        if (size >= MinClusterSize && t + 1 < numtriangles && misses <= target * size) {
+            clusters.push_back (t + 1);
+            /* evict everything for the next cluster */
+            time += cachesize + 1;
+            misses = 0;
+        }
+    }
+    clusters.push_back (numtriangles);
+    return clusters;
+}
+
+/* Concatenates the clusters sorted by decreasing occlusion potential. */
+std::vector<uint32_t> SortClusters (const std::vector<uint32_t> &indices, const float *positions, size_t stride,
+                                    const std::vector<size_t> &clusters) {
+    /* area weighted centroids and normals */
+    const size_t numclusters = clusters.size () - 1;
+    std::vector<double> centroids (numclusters * 3, 0.0), normals (numclusters * 3, 0.0);
+    double meshcentroid[3] = { 0, 0, 0 }, mesharea = 0;
+    for (size_t c = 0; c < numclusters; c++) {
+        double area = 0;
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const float *a = Position (positions, stride, indices[t * 3 + 0]);
+            const float *b = Position (positions, stride, indices[t * 3 + 1]);
+            const float *p = Position (positions, stride, indices[t * 3 + 2]);
+            float n[3];
+            Cross (a, b, p, n);
+            const double weight = std::sqrt (double (n[0]) * n[0] + double (n[1]) * n[1] + double (n[2]) * n[2]);
+            for (auto i = 0; i < 3; i++) {
+                centroids[c * 3 + i] += weight * (a[i] + b[i] + p[i]) / 3.0;
+                normals[c * 3 + i] += n[i];
+            }
+            area += weight;
+        }
+        for (auto i = 0; i < 3; i++) meshcentroid[i] += centroids[c * 3 + i];
+        mesharea += area;
+        if (area > 0) {
+            for (auto i = 0; i < 3; i++) centroids[c * 3 + i] /= area;
+        }
+    }
+    if (mesharea > 0) {
+        for (auto &m : meshcentroid) m /= mesharea;
+    }
+
+    std::vector<double> sortkeys (numclusters);
+    for (size_t c = 0; c < numclusters; c++) {
+        const double *n = &normals[c * 3];
+        const double length = std::sqrt (n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        double key = 0;
+        if (length > 0) {
+            for (auto i = 0; i < 3; i++) key += (centroids[c * 3 + i] - meshcentroid[i]) * n[i] / length;
+        }
+        sortkeys[c] = key;
+    }
+    std::vector<size_t> order (numclusters);
+    for (size_t c = 0; c < numclusters; c++) order[c] = c;
+    std::stable_sort (order.begin (), order.end (), [&] (size_t lhs, size_t rhs) {
+        return sortkeys[lhs] > sortkeys[rhs];
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve (indices.size ());
+    for (auto c : order) {
+        output.insert (output.end (), indices.begin () + clusters[c] * 3, indices.begin () + clusters[c + 1] * 3);
+    }
+    return output;
+}
+
+}
+
+void OptimizeOverdraw (std::vector<uint32_t> &indices, const float *positions, size_t stride,
+                       unsigned int numvertices, unsigned int cachesize, float threshold) {
+    const double acmr = AnalyzeVertexCache (indices, numvertices, cachesize).acmr;
+    /*
+     * The cold cache estimate does not bound the final ACMR exactly (the last
+     * cluster is not checked), so tighten the cutting target until it holds.
+     */
+    double factor = threshold;
+    for (auto attempt = 0; attempt < 6 && factor > 1.0; attempt++, factor = 1.0 + (factor - 1.0) * 0.5) {
+        std::vector<size_t> clusters = Clusters (indices, numvertices, cachesize, acmr * factor);
+        if (clusters.size () < 3) return;
+        std::vector<uint32_t> output = SortClusters (indices, positions, stride, clusters);
+        if (AnalyzeVertexCache (output, numvertices, cachesize).acmr <= acmr * threshold) {
+            indices.swap (output);
+            return;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_OVERDRAW_H
+#define ASSIMP2VF_OVERDRAW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Positions are read as three floats at positions + index * stride bytes.
+ */
+
+/*
+ * Average number of times each covered pixel is shaded when the triangle
+ * list is drawn in order with depth test and back face culling, measured
+ * by rasterizing it from a fixed set of orthographic views.
+ */
+double AnalyzeOverdraw (const std::vector<uint32_t> &indices, const float *positions, size_t stride);
+
+/*
+ * Reorders a (vertex cache optimized) triangle list to reduce overdraw
+ * (Sander et al. 2007): the list is cut into clusters wherever a cluster
+ * starting with a cold cache has a low enough ACMR, and the clusters are
+ * sorted by how much they face away from the mesh centroid, so that likely
+ * occluders are drawn first. The ACMR of the result is at most threshold
+ * times that of the input; if that cannot be achieved, the list is left
+ * unchanged.
+ */
+void OptimizeOverdraw (std::vector<uint32_t> &indices, const float *positions, size_t stride,
+                       unsigned int numvertices, unsigned int cachesize, float threshold);
+
+#endif /* !defined ASSIMP2VF_OVERDRAW_H */
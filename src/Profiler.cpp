@@ -0,0 +1,142 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+#include <iomanip>
+
+namespace {
+thread_local ProfileScope *current = nullptr;
+
+std::string Escape (const std::string &text) {
+    std::string escaped;
+    for (auto c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char) c < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            escaped += "\\u00";
+            escaped += hex[(c >> 4) & 0xF];
+            escaped += hex[c & 0xF];
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+double Milliseconds (int64_t nanoseconds) {
+    return nanoseconds * 1e-6;
+}
+}
+
+bool Profiler::enabled = false;
+
+Profiler::Profiler (void) {
+}
+
+Profiler &Profiler::get (void) {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::Record (const char *phase, const std::string *item, int64_t nanoseconds) {
+    std::lock_guard<std::mutex> lock (mutex);
+    Total &total = phases[phase];
+    total.calls++;
+    total.nanoseconds += nanoseconds;
+    if (item) {
+        Total &itemtotal = items[*item][phase];
+        itemtotal.calls++;
+        itemtotal.nanoseconds += nanoseconds;
+    }
+}
+
+void Profiler::Report (std::ostream &os, bool json) const {
+    std::lock_guard<std::mutex> lock (mutex);
+    if (json) {
+        os << "{" << std::endl << "  \"phases\": {";
+        const char *separator = "";
+        for (auto &phase : phases) {
+            os << separator << std::endl << "    \"" << Escape (phase.first) << "\": { \"calls\": " << phase.second.calls
+               << ", \"ms\": " << Milliseconds (phase.second.nanoseconds) << " }";
+            separator = ",";
+        }
+        os << std::endl << "  }," << std::endl << "  \"items\": {";
+        separator = "";
+        for (auto &item : items) {
+            os << separator << std::endl << "    \"" << Escape (item.first) << "\": {";
+            const char *inner = " ";
+            for (auto &phase : item.second) {
+                os << inner << "\"" << Escape (phase.first) << "\": " << Milliseconds (phase.second.nanoseconds);
+                inner = ", ";
+            }
+            os << " }";
+            separator = ",";
+        }
+        os << std::endl << "  }" << std::endl << "}" << std::endl;
+        return;
+    }
+
+    /* phases run concurrently, so their times do not add up to the wall clock time */
+    os << "profile (ms, calls):" << std::endl;
+    for (auto &phase : phases) {
+        os << "  " << std::left << std::setw (20) << phase.first << std::right << std::setw (12) << std::fixed
+           << std::setprecision (3) << Milliseconds (phase.second.nanoseconds) << std::setw (8) << phase.second.calls
+           << std::endl;
+    }
+    for (auto &item : items) {
+        os << "  " << item.first << ":";
+        for (auto &phase : item.second) {
+            os << " " << phase.first << " " << Milliseconds (phase.second.nanoseconds);
+        }
+        os << std::endl;
+    }
+    os.unsetf (std::ios_base::floatfield | std::ios_base::adjustfield);
+    os << std::setprecision (6);
+}
+
+double Profiler::GetSeconds (const std::string &phase) const {
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = phases.find (phase);
+    return it != phases.end () ? it->second.nanoseconds * 1e-9 : 0.0;
+}
+
+void Profiler::Reset (void) {
+    std::lock_guard<std::mutex> lock (mutex);
+    phases.clear ();
+    items.clear ();
+}
+
+void ProfileScope::Begin (const char *phase_, const std::string *item_) {
+    phase = phase_;
+    item = item_;
+    nested = 0;
+    parent = current;
+    current = this;
+    start = std::chrono::steady_clock::now ();
+}
+
+void ProfileScope::End (void) {
+    const int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now ()
+                                                                                   - start).count ();
+    current = parent;
+    if (parent) parent->nested += elapsed;
+    Profiler::get ().Record (phase, item, elapsed - nested);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_PROFILER_H
+#define ASSIMP2VF_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/*
+ * Collects the time spent in named phases, per phase and per item (node
+ * or file). Scene::Load is timed on the calling thread while the nodes
+ * load on the pool, so its time includes waiting for them. Disabled by
+ * default; it has to be enabled before any work starts and is then safe
+ * to use from several threads.
+ */
+class Profiler {
+public:
+    Profiler (const Profiler&) = delete;
+    Profiler &operator= (const Profiler&) = delete;
+    static Profiler &get (void);
+    static bool IsEnabled (void) {
+        return enabled;
+    }
+    void Enable (void) {
+        enabled = true;
+    }
+    void Record (const char *phase, const std::string *item, int64_t nanoseconds);
+    /* human-readable report, or a JSON object with "phases" and "items" */
+    void Report (std::ostream &os, bool json) const;
+    /* total time recorded for a phase in seconds */
+    double GetSeconds (const std::string &phase) const;
+    void Reset (void);
+private:
+    Profiler (void);
+    struct Total {
+        Total (void) : calls (0), nanoseconds (0) {
+        }
+        uint64_t calls;
+        int64_t nanoseconds;
+    };
+    static bool enabled;
+    mutable std::mutex mutex;
+    std::map<std::string, Total> phases;
+    std::map<std::string, std::map<std::string, Total>> items;
+};
+
+/*
+ * Times its own lifetime as the given phase. The time of scopes nested in
+ * it on the same thread is attributed to those, so each phase is reported
+ * with the time spent in it alone. Does nothing but test a flag while the
+ * Profiler is disabled. The item has to outlive the scope.
+ */
+class ProfileScope {
+public:
+    ProfileScope (const char *phase_, const std::string *item_ = nullptr) : phase (nullptr) {
+        if (Profiler::IsEnabled ()) Begin (phase_, item_);
+    }
+    ProfileScope (const char *phase_, const std::string &item_) : phase (nullptr) {
+        if (Profiler::IsEnabled ()) Begin (phase_, &item_);
+    }
+    ~ProfileScope (void) {
+        Stop ();
+    }
+    /* ends the phase before the end of the scope */
+    void Stop (void) {
+        if (phase) End ();
+        phase = nullptr;
+    }
+    ProfileScope (const ProfileScope&) = delete;
+    ProfileScope &operator= (const ProfileScope&) = delete;
+private:
+    void Begin (const char *phase, const std::string *item);
+    void End (void);
+    const char *phase;
+    const std::string *item;
+    ProfileScope *parent;
+    std::chrono::steady_clock::time_point start;
+    int64_t nested;
+};
+
+#endif /* !defined ASSIMP2VF_PROFILER_H */
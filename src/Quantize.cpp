@@ -0,0 +1,133 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Quantize.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+QuantizationRange ComputeQuantizationRange (const float *values, size_t count, unsigned int components,
+                                            size_t stride, float scale) {
+    QuantizationRange range;
+    if (count == 0) return range;
+    for (auto c = 0; c < components; c++) {
+        float minimum = scale * values[c], maximum = scale * values[c];
+        for (size_t i = 1; i < count; i++) {
+            minimum = std::min (minimum, scale * values[i * stride + c]);
+            maximum = std::max (maximum, scale * values[i * stride + c]);
+        }
+        range.offset[c] = minimum;
+        range.step[c] = (maximum - minimum) / 65535.0f;
+    }
+    return range;
+}
+
+uint16_t FloatToHalf (float f) {
+    uint32_t bits;
+    std::memcpy (&bits, &f, sizeof (bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t exponent = (bits >> 23) & 0xffu;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent == 0xffu) {
+        /* infinity or NaN (kept quiet) */
+        return sign | 0x7c00u | (mantissa ? 0x200u : 0u);
+    }
+    const int e = int (exponent) - 127 + 15;
+    if (e >= 31) {
+        return sign | 0x7c00u;
+    }
+    if (e <= 0) {
+        /* subnormal or zero */
+        if (e < -10) return sign;
+        mantissa |= 0x800000u;
+        const unsigned int shift = 14 - e;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+        return sign | half;
+    }
+    uint32_t half = (uint32_t (e) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1fffu;
+    /* a carry into the exponent is the correct result, up to infinity */
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+    return sign | half;
+}
+
+float HalfToFloat (uint16_t h) {
+    const uint32_t sign = uint32_t (h & 0x8000u) << 16;
+    const uint32_t exponent = (h >> 10) & 0x1fu;
+    uint32_t mantissa = h & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            int e = -1;
+            do {
+                e++;
+                mantissa <<= 1;
+            } while (!(mantissa & 0x400u));
+            bits = sign | (uint32_t (127 - 15 - e) << 23) | ((mantissa & 0x3ffu) << 13);
+        }
+    } else if (exponent == 0x1fu) {
+        bits = sign | 0x7f800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float f;
+    std::memcpy (&f, &bits, sizeof (f));
+    return f;
+}
+
+void OctahedralEncode (const float normal[3], unsigned int bits, int32_t encoded[2]) {
+    const float maximum = float ((1 << (bits - 1)) - 1);
+    const float length = std::fabs (normal[0]) + std::fabs (normal[1]) + std::fabs (normal[2]);
+    float x = 0.0f, y = 0.0f;
+    if (length > 0.0f) {
+        x = normal[0] / length;
+        y = normal[1] / length;
+        if (normal[2] < 0.0f) {
+            const float fx = (1.0f - std::fabs (y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float fy = (1.0f - std::fabs (x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = fx;
+            y = fy;
+        }
+    }
+    encoded[0] = static_cast<int32_t> (std::lround (std::max (-1.0f, std::min (1.0f, x)) * maximum));
+    encoded[1] = static_cast<int32_t> (std::lround (std::max (-1.0f, std::min (1.0f, y)) * maximum));
+}
+
+void OctahedralDecode (const int32_t encoded[2], unsigned int bits, float normal[3]) {
+    const float maximum = float ((1 << (bits - 1)) - 1);
+    float x = encoded[0] / maximum;
+    float y = encoded[1] / maximum;
+    float z = 1.0f - std::fabs (x) - std::fabs (y);
+    if (z < 0.0f) {
+        const float fx = (1.0f - std::fabs (y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float fy = (1.0f - std::fabs (x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    const float length = std::sqrt (x * x + y * y + z * z);
+    normal[0] = x / length;
+    normal[1] = y / length;
+    normal[2] = z / length;
+}
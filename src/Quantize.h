@@ -0,0 +1,68 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_QUANTIZE_H
+#define ASSIMP2VF_QUANTIZE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Per component range of an attribute; a quantized value q in [0, 65535]
+ * decodes to offset + q * step.
+ */
+struct QuantizationRange {
+    QuantizationRange (void) : offset { 0, 0, 0 }, step { 0, 0, 0 } {
+    }
+    float offset[3];
+    float step[3];
+};
+
+/*
+ * Range of count vectors with the given number (at most 3) of components,
+ * each starting stride floats after the previous one, after multiplying
+ * them by scale.
+ */
+QuantizationRange ComputeQuantizationRange (const float *values, size_t count, unsigned int components,
+                                            size_t stride, float scale);
+
+inline uint16_t QuantizeUnorm16 (float value, float offset, float step) {
+    if (!(step > 0)) return 0;
+    float q = (value - offset) / step + 0.5f;
+    if (q < 0.0f) q = 0.0f;
+    if (q > 65535.0f) q = 65535.0f;
+    return static_cast<uint16_t> (q);
+}
+
+inline float DequantizeUnorm16 (uint16_t q, float offset, float step) {
+    return offset + q * step;
+}
+
+/* IEEE 754 binary16 conversion, rounding to nearest even. */
+uint16_t FloatToHalf (float f);
+float HalfToFloat (uint16_t h);
+
+/*
+ * Octahedral encoding of a unit vector as two signed normalized integers
+ * of the given number of bits (8 or 16).
+ */
+void OctahedralEncode (const float normal[3], unsigned int bits, int32_t encoded[2]);
+void OctahedralDecode (const int32_t encoded[2], unsigned int bits, float normal[3]);
+
+#endif /* !defined ASSIMP2VF_QUANTIZE_H */
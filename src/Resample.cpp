@@ -0,0 +1,255 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Resample.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ASSIMP2VF_RESAMPLE_SSE2
+#endif
+
+namespace {
+
+/*
+ * acos on [0, 1] (Abramowitz and Stegun 4.4.46, error below 2e-8) and sin on
+ * [0, pi/2] (Taylor series up to x^11); the scalar and the SSE2 kernels use
+ * the same polynomials, so they agree.
+ */
+const float acoscoeffs[8] = { 1.5707963050f, -0.2145988016f, 0.0889789874f, -0.0501743046f,
+                              0.0308918810f, -0.0170881256f, 0.0066700901f, -0.0012624911f };
+const float sincoeffs[5] = { -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f, -1.0f / 39916800.0f };
+/* below this distance from 1 the cosine of the angle is treated as 1 and lerp is used */
+const float slerpepsilon = 1e-6f;
+
+float Acos (float x) {
+    float p = acoscoeffs[7];
+    for (auto i = 6; i >= 0; i--) p = p * x + acoscoeffs[i];
+    return std::sqrt (1.0f - x) * p;
+}
+
+float Sin (float x) {
+    const float x2 = x * x;
+    float p = sincoeffs[4];
+    for (auto i = 3; i >= 0; i--) p = p * x2 + sincoeffs[i];
+    return x + x * x2 * p;
+}
+
+void SlerpScalar (const QuatKeyBatch &batch, std::vector<float> out[4], size_t i) {
+    float d = batch.a[0][i] * batch.b[0][i] + batch.a[1][i] * batch.b[1][i]
+            + batch.a[2][i] * batch.b[2][i] + batch.a[3][i] * batch.b[3][i];
+    const float sign = d < 0.0f ? -1.0f : 1.0f;
+    d = std::min (std::fabs (d), 1.0f);
+    const float f = batch.f[i];
+    float s0 = 1.0f - f, s1 = f;
+    if (1.0f - d > slerpepsilon) {
+        const float theta = Acos (d);
+        const float inverse = 1.0f / Sin (theta);
+        s0 = Sin ((1.0f - f) * theta) * inverse;
+        s1 = Sin (f * theta) * inverse;
+    }
+    s1 *= sign;
+    for (auto c = 0; c < 4; c++) out[c][i] = s0 * batch.a[c][i] + s1 * batch.b[c][i];
+}
+
+#ifdef ASSIMP2VF_RESAMPLE_SSE2
+__m128 Acos (__m128 x) {
+    __m128 p = _mm_set1_ps (acoscoeffs[7]);
+    for (auto i = 6; i >= 0; i--) p = _mm_add_ps (_mm_mul_ps (p, x), _mm_set1_ps (acoscoeffs[i]));
+    return _mm_mul_ps (_mm_sqrt_ps (_mm_sub_ps (_mm_set1_ps (1.0f), x)), p);
+}
+
+__m128 Sin (__m128 x) {
+    const __m128 x2 = _mm_mul_ps (x, x);
+    __m128 p = _mm_set1_ps (sincoeffs[4]);
+    for (auto i = 3; i >= 0; i--) p = _mm_add_ps (_mm_mul_ps (p, x2), _mm_set1_ps (sincoeffs[i]));
+    return _mm_add_ps (x, _mm_mul_ps (_mm_mul_ps (x, x2), p));
+}
+#endif
+
+/* appends the components of a key value, quaternions as x, y, z, w */
+void Append (std::vector<float> *target, const aiVector3D &v) {
+    target[0].push_back (v.x);
+    target[1].push_back (v.y);
+    target[2].push_back (v.z);
+}
+
+void Append (std::vector<float> *target, const aiQuaternion &q) {
+    target[0].push_back (q.x);
+    target[1].push_back (q.y);
+    target[2].push_back (q.z);
+    target[3].push_back (q.w);
+}
+
+/*
+ * Adds one interpolation job per sample of a track; the keys bracketing a
+ * sample are found by walking forward, as sample times only increase.
+ */
+template<typename Key, typename Batch, typename Value>
+void AddJobs (Batch &batch, const Key *keys, unsigned int count, unsigned int numsamples, double ticksperframe,
+              const Value &fallback) {
+    unsigned int cursor = 0;
+    for (unsigned int k = 0; k < numsamples; k++) {
+        if (count == 0) {
+            Append (batch.a, fallback);
+            Append (batch.b, fallback);
+            batch.f.push_back (0.0f);
+            continue;
+        }
+        const double time = k * ticksperframe;
+        while (cursor + 1 < count && keys[cursor + 1].mTime <= time) cursor++;
+        const unsigned int next = std::min (cursor + 1, count - 1);
+        float f = 0.0f;
+        if (next != cursor && keys[next].mTime > keys[cursor].mTime) {
+            f = float ((time - keys[cursor].mTime) / (keys[next].mTime - keys[cursor].mTime));
+            f = std::max (0.0f, std::min (f, 1.0f));
+        }
+        Append (batch.a, keys[cursor].mValue);
+        Append (batch.b, keys[next].mValue);
+        batch.f.push_back (f);
+    }
+}
+
+/* pads all arrays with neutral jobs to a multiple of four */
+template<typename Batch>
+void Pad (Batch &batch, unsigned int components) {
+    while (batch.f.size () % 4) {
+        for (auto c = 0; c < components; c++) {
+            batch.a[c].push_back (c == 3 ? 1.0f : 0.0f);
+            batch.b[c].push_back (c == 3 ? 1.0f : 0.0f);
+        }
+        batch.f.push_back (0.0f);
+    }
+}
+
+double TicksPerSecond (const aiAnimation *anim) {
+    return anim->mTicksPerSecond != 0 ? anim->mTicksPerSecond : 1.0;
+}
+
+}
+
+void LerpKeys (const VectorKeyBatch &batch, std::vector<float> out[3]) {
+    const size_t count = batch.f.size ();
+    for (auto c = 0; c < 3; c++) out[c].resize (count);
+    size_t i = 0;
+#ifdef ASSIMP2VF_RESAMPLE_SSE2
+    for (; i + 4 <= count; i += 4) {
+        const __m128 f = _mm_loadu_ps (&batch.f[i]);
+        for (auto c = 0; c < 3; c++) {
+            const __m128 a = _mm_loadu_ps (&batch.a[c][i]);
+            const __m128 b = _mm_loadu_ps (&batch.b[c][i]);
+            _mm_storeu_ps (&out[c][i], _mm_add_ps (a, _mm_mul_ps (f, _mm_sub_ps (b, a))));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        for (auto c = 0; c < 3; c++) out[c][i] = batch.a[c][i] + batch.f[i] * (batch.b[c][i] - batch.a[c][i]);
+    }
+}
+
+void SlerpKeys (const QuatKeyBatch &batch, std::vector<float> out[4]) {
+    const size_t count = batch.f.size ();
+    for (auto c = 0; c < 4; c++) out[c].resize (count);
+    size_t i = 0;
+#ifdef ASSIMP2VF_RESAMPLE_SSE2
+    const __m128 one = _mm_set1_ps (1.0f);
+    const __m128 signbit = _mm_set1_ps (-0.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 a[4], b[4];
+        for (auto c = 0; c < 4; c++) {
+            a[c] = _mm_loadu_ps (&batch.a[c][i]);
+            b[c] = _mm_loadu_ps (&batch.b[c][i]);
+        }
+        __m128 d = _mm_add_ps (_mm_add_ps (_mm_mul_ps (a[0], b[0]), _mm_mul_ps (a[1], b[1])),
+                               _mm_add_ps (_mm_mul_ps (a[2], b[2]), _mm_mul_ps (a[3], b[3])));
+        /* take the shorter arc: flip b where the cosine is negative */
+        const __m128 sign = _mm_and_ps (d, signbit);
+        d = _mm_min_ps (_mm_andnot_ps (signbit, d), one);
+        const __m128 f = _mm_loadu_ps (&batch.f[i]);
+        const __m128 g = _mm_sub_ps (one, f);
+        const __m128 theta = Acos (d);
+        const __m128 inverse = _mm_div_ps (one, Sin (theta));
+        const __m128 near = _mm_cmple_ps (_mm_sub_ps (one, d), _mm_set1_ps (slerpepsilon));
+        const __m128 s0 = _mm_or_ps (_mm_and_ps (near, g), _mm_andnot_ps (near, _mm_mul_ps (Sin (_mm_mul_ps (g, theta)), inverse)));
+        __m128 s1 = _mm_or_ps (_mm_and_ps (near, f), _mm_andnot_ps (near, _mm_mul_ps (Sin (_mm_mul_ps (f, theta)), inverse)));
+        s1 = _mm_xor_ps (s1, sign);
+        for (auto c = 0; c < 4; c++) {
+            _mm_storeu_ps (&out[c][i], _mm_add_ps (_mm_mul_ps (s0, a[c]), _mm_mul_ps (s1, b[c])));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        SlerpScalar (batch, out, i);
+    }
+}
+
+unsigned int ResampledCount (const aiAnimation *anim, double fps) {
+    const double frames = anim->mDuration / TicksPerSecond (anim) * fps;
+    return (unsigned int) (std::ceil (frames - 1e-6)) + 1;
+}
+
+std::vector<ResampledChannel> ResampleAnimation (const aiAnimation *anim, double fps) {
+    const unsigned int numsamples = ResampledCount (anim, fps);
+    const double ticksperframe = TicksPerSecond (anim) / fps;
+
+    /* positions of all channels, then scalings of all channels */
+    VectorKeyBatch vectors;
+    QuatKeyBatch quats;
+    for (auto c = 0; c < 3; c++) {
+        vectors.a[c].reserve (size_t (anim->mNumChannels) * numsamples * 2 + 3);
+        vectors.b[c].reserve (size_t (anim->mNumChannels) * numsamples * 2 + 3);
+    }
+    for (auto channel = 0; channel < anim->mNumChannels; channel++) {
+        const aiNodeAnim *nodeanim = anim->mChannels[channel];
+        AddJobs (vectors, nodeanim->mPositionKeys, nodeanim->mNumPositionKeys, numsamples, ticksperframe,
+                 aiVector3D (0, 0, 0));
+    }
+    for (auto channel = 0; channel < anim->mNumChannels; channel++) {
+        const aiNodeAnim *nodeanim = anim->mChannels[channel];
+        AddJobs (vectors, nodeanim->mScalingKeys, nodeanim->mNumScalingKeys, numsamples, ticksperframe,
+                 aiVector3D (1, 1, 1));
+        AddJobs (quats, nodeanim->mRotationKeys, nodeanim->mNumRotationKeys, numsamples, ticksperframe,
+                 aiQuaternion ());
+    }
+    Pad (vectors, 3);
+    Pad (quats, 4);
+
+    std::vector<float> lerped[3], slerped[4];
+    LerpKeys (vectors, lerped);
+    SlerpKeys (quats, slerped);
+
+    std::vector<ResampledChannel> channels (anim->mNumChannels);
+    const size_t scalingoffset = size_t (anim->mNumChannels) * numsamples;
+    for (auto channel = 0; channel < anim->mNumChannels; channel++) {
+        ResampledChannel &result = channels[channel];
+        result.positions.resize (numsamples * 3);
+        result.scalings.resize (numsamples * 3);
+        result.rotations.resize (numsamples * 4);
+        for (unsigned int k = 0; k < numsamples; k++) {
+            const size_t job = size_t (channel) * numsamples + k;
+            for (auto c = 0; c < 3; c++) {
+                result.positions[k * 3 + c] = lerped[c][job];
+                result.scalings[k * 3 + c] = lerped[c][scalingoffset + job];
+            }
+            for (auto c = 0; c < 4; c++) result.rotations[k * 4 + c] = slerped[c][job];
+        }
+    }
+    return channels;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_RESAMPLE_H
+#define ASSIMP2VF_RESAMPLE_H
+
+#include <assimp/scene.h>
+#include <vector>
+
+/*
+ * Interpolation jobs in structure of arrays layout: job i blends a[.][i]
+ * towards b[.][i] by f[i]. Batches of all channels of an animation are
+ * processed by one call, four jobs at a time with SSE2.
+ */
+struct VectorKeyBatch {
+    std::vector<float> a[3], b[3], f;
+};
+struct QuatKeyBatch {
+    std::vector<float> a[4], b[4], f;
+};
+
+/* component wise linear interpolation, out[c] is resized to the number of jobs */
+void LerpKeys (const VectorKeyBatch &batch, std::vector<float> out[3]);
+/* spherical linear interpolation along the shorter arc, as aiQuaternion::Interpolate */
+void SlerpKeys (const QuatKeyBatch &batch, std::vector<float> out[4]);
+
+/*
+ * An animation channel sampled at a fixed rate: positions and scalings as
+ * x, y, z triples, rotations as x, y, z, w quadruples, one per sample.
+ */
+struct ResampledChannel {
+    std::vector<float> positions;
+    std::vector<float> scalings;
+    std::vector<float> rotations;
+};
+
+/*
+ * Evaluates every channel of anim at 0, 1 / fps, 2 / fps, ... seconds (ticks
+ * if the animation has no tick rate) until the duration is covered; keys
+ * are held constant before the first and after the last key.
+ */
+std::vector<ResampledChannel> ResampleAnimation (const aiAnimation *anim, double fps);
+/* number of samples ResampleAnimation produces per channel */
+unsigned int ResampledCount (const aiAnimation *anim, double fps);
+
+#endif /* !defined ASSIMP2VF_RESAMPLE_H */
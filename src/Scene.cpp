@@ -19,23 +19,65 @@
 
 #include "Scene.h"
 #include "Node.h"
-#include "Arguments.h"
+#include "ThreadPool.h"
+#include "Writer.h"
+#include "Manifest.h"
+#include "Keyframes.h"
+#include "Resample.h"
+#include "Profiler.h"
+#include <atomic>
+#include <cmath>
 #include <queue>
 #include <iostream>
 #include <fstream>
-#include <openvf/openvf.h>
 #include <sstream>
 #include <set>
+#include <stdexcept>
 
-Scene::Scene (void) {
+void SaveVF (VF &vf, const std::string &outputdir, const std::string &filename,
+             const Options &options, Manifest *manifest) {
+    ProfileScope profile ("write", filename);
+    ContentHash hash;
+    hash.Update (vf.GetHash ());
+    hash.Update (options.scale);
+    hash.Update (options.flipUV);
+    if (manifest && manifest->IsUnchanged (filename, hash.Get ())) {
+        return;
+    }
+    vfSave (vf, (outputdir + filename).c_str ());
+    if (manifest) {
+        manifest->Update (filename, hash.Get ());
+    }
+}
+
+Scene::Scene (const Options &options_, const std::string &outputdir_, const std::shared_ptr<Manifest> &manifest_)
+    : options (options_), outputdir (outputdir_), manifest (manifest_), nodeswritten (false) {
 }
 
 Scene::~Scene (void) {
 }
 
-void Scene::Load (const aiScene *scene_) {
+static void CountMeshReferences (const aiNode *node, std::atomic<unsigned int> *references) {
+    for (auto i = 0; i < node->mNumMeshes; i++) {
+        references[node->mMeshes[i]]++;
+    }
+    for (auto i = 0; i < node->mNumChildren; i++) {
+        CountMeshReferences (node->mChildren[i], references);
+    }
+}
+
+void Scene::Load (const std::shared_ptr<aiScene> &scene_, ThreadPool &pool, Writer *writer) {
+    ProfileScope profile ("scene");
     scene = scene_;
+    nodeswritten = writer != nullptr;
     std::queue<aiNode*> nodequeue;
+    /* number of nodes that still have to convert each mesh */
+    std::unique_ptr<std::atomic<unsigned int>[]> references (new std::atomic<unsigned int>[scene->mNumMeshes]);
+    for (auto i = 0; i < scene->mNumMeshes; i++) {
+        references[i] = 0;
+    }
+    CountMeshReferences (scene->mRootNode, references.get ());
+    TaskGroup group (pool);
 
     nodequeue.push (scene->mRootNode);
     while (!nodequeue.empty ()) {
@@ -43,13 +85,53 @@ void Scene::Load (const aiScene *scene_) {
         nodequeue.pop ();
 
         nodelist.emplace_back (new Node (this));
-        nodelist.back ()->Load (ainode);
-        nodemap[ainode->mName.C_Str ()] = nodelist.back ().get ();
+        Node *node = nodelist.back ().get ();
+        group.Submit ([this, node, ainode, writer, &references] () {
+            node->Load (ainode);
+            for (auto i = 0; i < ainode->mNumMeshes; i++) {
+                const unsigned int meshid = ainode->mMeshes[i];
+                if (--references[meshid] == 0) {
+                    delete scene->mMeshes[meshid];
+                    scene->mMeshes[meshid] = nullptr;
+                }
+            }
+            if (writer && node->HasOutput ()) {
+                std::shared_ptr<Scene> self (shared_from_this ());
+                writer->Submit ([self, node] () {
+                    SaveVF (node->GetVF (), self->outputdir, node->GetName () + ".vf", self->options, self->manifest.get ());
+                    if (self->options.streaming) node->GetVF ().Free ();
+                });
+            } else if (options.streaming) {
+                node->GetVF ().Free ();
+            }
+        });
+        nodemap[ainode->mName.C_Str ()] = node;
 
         for (auto i = 0; i < ainode->mNumChildren; i++) {
             nodequeue.push (ainode->mChildren[i]);
         }
     }
+    group.Wait ();
+
+    for (auto &node : nodelist) {
+        std::cerr << node->GetReport ();
+    }
+
+    for (auto i = 0; i < scene->mNumMaterials; i++) {
+        aiString aimatname;
+        scene->mMaterials[i]->Get (AI_MATKEY_NAME, aimatname);
+        std::string matname (aimatname.data, aimatname.length);
+        if (!matname.compare (0, 9, "Material-"))
+            matname.erase (0, 9);
+        materialnames.push_back (matname);
+    }
+    for (auto i = 0; i < scene->mNumAnimations; i++) {
+        animations.emplace_back (scene->mAnimations[i]);
+    }
+    delete[] scene->mAnimations;
+    scene->mAnimations = nullptr;
+    scene->mNumAnimations = 0;
+    scene.reset ();
 }
 
 std::ostream &operator<< (std::ostream &os, const aiVector3D &v) {
@@ -60,24 +142,121 @@ std::ostream &operator<< (std::ostream &os, const aiQuaternion &q) {
     return (os << "{ " << q.x << ", " << q.y << ", " << q.z << ", " << q.w << " }");
 }
 
-void SaveNodeAnim (aiNodeAnim *anim, const std::string &filename) {
-    struct VF {
-        VF (void) : vf (vfAlloc ()) { }
-        ~VF (void) { vfFree (vf); }
-        operator vf_t* (void) { return vf; }
-        vf_t *vf;
-    };
+static void AppendKeyValue (std::vector<float> &values, const aiVector3D &v, float scale) {
+    values.push_back (scale * v.x);
+    values.push_back (scale * v.y);
+    values.push_back (scale * v.z);
+}
+
+static void AppendKeyValue (std::vector<float> &values, const aiQuaternion &q, float) {
+    values.push_back (q.x);
+    values.push_back (q.y);
+    values.push_back (q.z);
+    values.push_back (q.w);
+}
+
+/*
+ * Adds the kept keys as <name>S and their times as <name>TIMES.
+ */
+template<typename Key>
+static void AddKeySets (VF &vf, const std::string &name, unsigned int components, const Key *keys,
+                        const std::vector<uint32_t> &kept, double timescale, float scale) {
+    std::vector<float> values, times;
+    values.reserve (kept.size () * components);
+    times.reserve (kept.size ());
+    for (auto index : kept) {
+        AppendKeyValue (values, keys[index].mValue, scale);
+        times.push_back (float (keys[index].mTime * timescale));
+    }
+    vf.AddSet (name + "S", components, VF_FLOAT, kept.size (), values.data ());
+    vf.AddSet (name + "TIMES", 1, VF_FLOAT, kept.size (), times.data ());
+}
+
+/*
+ * Key counts of one animation, summed over its channels as they are
+ * written; the total is reported once the last channel is done.
+ */
+class KeyframeTotals {
+public:
+    KeyframeTotals (const std::string &name_) : name (name_), keys (0), kept (0) {
+    }
+    ~KeyframeTotals (void) {
+        std::ostringstream report;
+        report << name << ": keys reduced from " << keys << " to " << kept << std::endl;
+        std::cerr << report.str ();
+    }
+    void Add (unsigned int keys_, unsigned int kept_) {
+        keys += keys_;
+        kept += kept_;
+    }
+private:
+    std::string name;
+    std::atomic<unsigned int> keys, kept;
+};
+
+/*
+ * Writes only the keys needed to reproduce the channel within the
+ * tolerances of the options, together with their times in seconds (or
+ * ticks, if the animation has no tick rate). Tracks that stay at the
+ * node's rest transform are left out.
+ */
+static unsigned int AddReducedAnimSets (VF &vf, const aiNodeAnim *anim, const Node *node, double tickspersecond,
+                                        const Options &options) {
+    const float scale = options.scale;
+    const double timescale = tickspersecond != 0 ? 1.0 / tickspersecond : 1.0;
+
+    /* the tolerance applies to the scaled output, a negative scale only mirrors it */
+    std::vector<uint32_t> positions = ReduceVectorKeys (anim->mPositionKeys, anim->mNumPositionKeys,
+                                                        options.keyframetranslation / std::fabs (scale));
+    if (positions.size () == 1 && node && std::fabs (scale) * (anim->mPositionKeys[0].mValue
+        - node->GetPosition ()).Length () <= options.keyframetranslation) {
+        positions.clear ();
+    }
+    std::vector<uint32_t> scalings = ReduceVectorKeys (anim->mScalingKeys, anim->mNumScalingKeys, options.keyframescale);
+    if (scalings.size () == 1 && node && (anim->mScalingKeys[0].mValue - node->GetScaling ()).Length ()
+        <= options.keyframescale) {
+        scalings.clear ();
+    }
+    std::vector<uint32_t> rotations = ReduceQuatKeys (anim->mRotationKeys, anim->mNumRotationKeys, options.keyframeangle);
+    if (rotations.size () == 1 && node && QuatAngle (anim->mRotationKeys[0].mValue, node->GetRotation ())
+        <= options.keyframeangle) {
+        rotations.clear ();
+    }
+
+    if (!positions.empty ()) {
+        AddKeySets (vf, "POSITION", 3, anim->mPositionKeys, positions, timescale, scale);
+    }
+    if (!scalings.empty ()) {
+        AddKeySets (vf, "SCALING", 3, anim->mScalingKeys, scalings, timescale, 1.0f);
+    }
+    if (!rotations.empty ()) {
+        AddKeySets (vf, "ROTATION", 4, anim->mRotationKeys, rotations, timescale, 1.0f);
+    }
+    return positions.size () + scalings.size () + rotations.size ();
+}
+
+unsigned int SaveNodeAnim (aiNodeAnim *anim, const Node *node, double tickspersecond,
+                           const std::string &outputdir, const std::string &filename, const Options &options,
+                           Manifest *manifest) {
+    ProfileScope profile ("animation", filename);
     VF vf;
 
+    if (options.keyframes) {
+        const unsigned int kept = AddReducedAnimSets (vf, anim, node, tickspersecond, options);
+        SaveVF (vf, outputdir, filename, options, manifest);
+        return kept;
+    }
+
     {
+        const float scale = options.scale;
         std::vector<float> positions;
         positions.resize (anim->mNumPositionKeys * 3);
         for (auto i = 0; i < anim->mNumPositionKeys; i++) {
-            positions[i * 3 + 0] = Arguments::get ().scale () * anim->mPositionKeys[i].mValue.x;
-            positions[i * 3 + 1] = Arguments::get ().scale () * anim->mPositionKeys[i].mValue.y;
-            positions[i * 3 + 2] = Arguments::get ().scale () * anim->mPositionKeys[i].mValue.z;
+            positions[i * 3 + 0] = scale * anim->mPositionKeys[i].mValue.x;
+            positions[i * 3 + 1] = scale * anim->mPositionKeys[i].mValue.y;
+            positions[i * 3 + 2] = scale * anim->mPositionKeys[i].mValue.z;
         }
-        vfAddSet (vf, "POSITIONS", 3, VF_FLOAT, anim->mNumPositionKeys, positions.data (), 0);
+        vf.AddSet ("POSITIONS", 3, VF_FLOAT, anim->mNumPositionKeys, positions.data ());
     }
     {
         std::vector<float> scalings;
@@ -87,7 +266,7 @@ void SaveNodeAnim (aiNodeAnim *anim, const std::string &filename) {
             scalings[i * 3 + 1]= anim->mScalingKeys[i].mValue.y;
             scalings[i * 3 + 2]= anim->mScalingKeys[i].mValue.z;
         }
-        vfAddSet (vf, "SCALINGS", 3, VF_FLOAT, anim->mNumScalingKeys, scalings.data (), 0);
+        vf.AddSet ("SCALINGS", 3, VF_FLOAT, anim->mNumScalingKeys, scalings.data ());
     }
     {
         std::vector<float> rotations;
@@ -98,33 +277,50 @@ void SaveNodeAnim (aiNodeAnim *anim, const std::string &filename) {
             rotations[i * 4 + 2]= anim->mRotationKeys[i].mValue.z;
             rotations[i * 4 + 3]= anim->mRotationKeys[i].mValue.w;
         }
-        vfAddSet (vf, "ROTATIONS", 4, VF_FLOAT, anim->mNumRotationKeys, rotations.data (), 0);
+        vf.AddSet ("ROTATIONS", 4, VF_FLOAT, anim->mNumRotationKeys, rotations.data ());
     }
 
-    vfSave (vf, filename.c_str ());
+    SaveVF (vf, outputdir, filename, options, manifest);
+    return anim->mNumPositionKeys + anim->mNumScalingKeys + anim->mNumRotationKeys;
+}
+
+/*
+ * Writes a channel sampled at a fixed rate; the sets are the same as for
+ * the original keys, with one entry per sample.
+ */
+void SaveResampledAnim (const ResampledChannel &channel, const std::string &outputdir, const std::string &filename,
+                        const Options &options, Manifest *manifest) {
+    ProfileScope profile ("animation", filename);
+    VF vf;
+    std::vector<float> positions (channel.positions);
+    for (auto &position : positions) position *= options.scale;
+    vf.AddSet ("POSITIONS", 3, VF_FLOAT, positions.size () / 3, positions.data ());
+    vf.AddSet ("SCALINGS", 3, VF_FLOAT, channel.scalings.size () / 3, channel.scalings.data ());
+    vf.AddSet ("ROTATIONS", 4, VF_FLOAT, channel.rotations.size () / 4, channel.rotations.data ());
+    SaveVF (vf, outputdir, filename, options, manifest);
 }
 
 void Scene::ListOutputs (void) {
     for (auto &node : nodelist) {
-        if (vfGetFirstSet (node->GetVF ()) != nullptr) {
-            std::cout << node->GetName () << ".vf" << std::endl;
+        if (node->HasOutput ()) {
+            std::cout << outputdir << node->GetName () << ".vf" << std::endl;
         }
     }
 
-    for (auto animid = 0; animid < scene->mNumAnimations; animid++) {
-        aiAnimation *anim = scene->mAnimations[animid];
+    for (auto animid = 0; animid < animations.size (); animid++) {
+        aiAnimation *anim = animations[animid].get ();
         std::string animname = std::string (anim->mName.data, anim->mName.length);
         if (animname.empty ()) {
             std::stringstream stream;
             stream << "anim";
-            if (scene->mNumAnimations > 1) stream << animid;
+            if (animations.size () > 1) stream << animid;
             animname = stream.str ();
         }
         for (auto channel = 0; channel < anim->mNumChannels; channel++) {
             aiNodeAnim *nodeanim = anim->mChannels[channel];
             std::string nodename = std::string (nodeanim->mNodeName.data, nodeanim->mNodeName.length);
             std::string filename = nodename + "_" + animname + ".vf";
-            std::cout << filename << std::endl;
+            std::cout << outputdir << filename << std::endl;
         }
     }
 
@@ -132,12 +328,7 @@ void Scene::ListOutputs (void) {
 
 void Scene::ListMaterials (void) {
     std::cout << "materials = {" << std::endl;
-    for (auto i = 0; i < scene->mNumMaterials; i++) {
-        aiString aimatname;
-        scene->mMaterials[i]->Get (AI_MATKEY_NAME, aimatname);
-        std::string matname (aimatname.data, aimatname.length);
-        if (!matname.compare (0, 9, "Material-"))
-            matname.erase (0, 9);
+    for (auto &matname : materialnames) {
         std::cout << "  " << matname << " = Material {" << std::endl;
         std::cout << "  };" << std::endl;
     }
@@ -145,14 +336,14 @@ void Scene::ListMaterials (void) {
 }
 
 void Scene::ListAnimationData (void) {
-    for (auto animid = 0; animid < scene->mNumAnimations; animid++) {
+    for (auto animid = 0; animid < animations.size (); animid++) {
         std::cout << std::endl;
-        aiAnimation *anim = scene->mAnimations[animid];
+        aiAnimation *anim = animations[animid].get ();
         std::string animname = std::string (anim->mName.data, anim->mName.length);
         if (animname.empty ()) {
             std::stringstream stream;
             stream << "anim";
-            if (scene->mNumAnimations > 1) stream << animid;
+            if (animations.size () > 1) stream << animid;
             animname = stream.str ();
         }
         std::cout << "animationdata." << animname << " = AnimationData {" << std::endl;
@@ -162,7 +353,9 @@ void Scene::ListAnimationData (void) {
             std::string filename = nodename + "_" + animname + ".vf";
             std::cout << "  [nodes." << nodename << "] = \"" << filename << "\";" << std::endl;
         }
-        if (anim->mTicksPerSecond != 0) {
+        if (options.resample > 0.0f) {
+            std::cout << "  fps = " << options.resample << ";" << std::endl;
+        } else if (anim->mTicksPerSecond != 0) {
             std::cout << "  fps = " << (anim->mChannels[0]->mNumPositionKeys - 1)
                                        / (anim->mTicksPerSecond * anim->mDuration) << ";" << std::endl;
         }
@@ -182,35 +375,25 @@ void Scene::ListNodes (void) {
                 std::cout << "  parent = nodes." << node->GetParent () << ";" << std::endl;
             }
         }
-        if (vfGetFirstSet (node->GetVF ()) != nullptr) {
+        if (node->HasOutput ()) {
             std::cout << "  filename = \"" << node->GetName () << ".vf\";" << std::endl;
         }
         if (!node->GetMaterials ().empty ()) {
             if (node->GetMaterials ().size () > 1) {
                 std::cout << "  submeshes = {" << std::endl;
                 for (auto &material : node->GetMaterials ()) {
-                    aiString aimatname;
-                    scene->mMaterials[material]->Get (AI_MATKEY_NAME, aimatname);
-                    std::string matname (aimatname.data, aimatname.length);
-                    if (!matname.compare (0, 9, "Material-"))
-                        matname.erase (0, 9);
                     std::cout << "    {" << std::endl;
-                    std::cout << "      material = materials." << matname << ";" << std::endl;
+                    std::cout << "      material = materials." << materialnames[material] << ";" << std::endl;
                     std::cout << "      uniforms = uniforms;" << std::endl;
                     std::cout << "    };" << std::endl;
                 }
                 std::cout << "  };" << std::endl;
             } else {
-                aiString aimatname;
-                scene->mMaterials[node->GetMaterials ()[0]]->Get (AI_MATKEY_NAME, aimatname);
-                std::string matname (aimatname.data, aimatname.length);
-                if (!matname.compare (0, 9, "Material-"))
-                    matname.erase (0, 9);
-                std::cout << "  material = materials." << matname << ";" << std::endl;
+                std::cout << "  material = materials." << materialnames[node->GetMaterials ()[0]] << ";" << std::endl;
                 std::cout << "  uniforms = uniforms;" << std::endl;
             }
         }
-        std::cout << "  position = " << (Arguments::get ().scale () * node->GetPosition ()) << ";" << std::endl;
+        std::cout << "  position = " << (options.scale * node->GetPosition ()) << ";" << std::endl;
         std::cout << "  scale = " << node->GetScaling () << ";" << std::endl;
         std::cout << "  rotation = " << node->GetRotation () << ";" << std::endl;
         if (node->GetType() == Node::Mesh) {
@@ -221,27 +404,66 @@ void Scene::ListNodes (void) {
 
 }
 
-void Scene::Save (void) {
-    for (auto &node : nodelist) {
-        if (vfGetFirstSet (node->GetVF ()) != nullptr) {
-            vfSave (node->GetVF (), (node->GetName () + ".vf").c_str ());
+void Scene::Save (Writer &writer) {
+    if (!nodeswritten && options.streaming) {
+        throw std::runtime_error ("streaming conversion requires the nodes to be written while loading");
+    }
+    if (!nodeswritten) {
+        for (auto &node : nodelist) {
+            if (node->HasOutput ()) {
+                std::shared_ptr<Scene> self (shared_from_this ());
+                Node *n = node.get ();
+                writer.Submit ([self, n] () {
+                    SaveVF (n->GetVF (), self->outputdir, n->GetName () + ".vf", self->options, self->manifest.get ());
+                });
+            }
         }
+        nodeswritten = true;
     }
 
-    for (auto animid = 0; animid < scene->mNumAnimations; animid++) {
-        aiAnimation *anim = scene->mAnimations[animid];
+    for (auto animid = 0; animid < animations.size (); animid++) {
+        aiAnimation *anim = animations[animid].get ();
         std::string animname = std::string (anim->mName.data, anim->mName.length);
         if (animname.empty ()) {
             std::stringstream stream;
             stream << "anim";
-            if (scene->mNumAnimations > 1) stream << animid;
+            if (animations.size () > 1) stream << animid;
             animname = stream.str ();
         }
+        /* all channels are interpolated in one batch */
+        std::shared_ptr<std::vector<ResampledChannel>> resampled;
+        if (options.resample > 0.0f) {
+            ProfileScope profile ("resampling", animname);
+            resampled = std::make_shared<std::vector<ResampledChannel>> (ResampleAnimation (anim, options.resample));
+        }
+        std::shared_ptr<KeyframeTotals> totals;
+        if (!resampled && options.keyframes) {
+            totals = std::make_shared<KeyframeTotals> (animname);
+        }
         for (auto channel = 0; channel < anim->mNumChannels; channel++) {
             aiNodeAnim *nodeanim = anim->mChannels[channel];
             std::string nodename = std::string (nodeanim->mNodeName.data, nodeanim->mNodeName.length);
             std::string filename = nodename + "_" + animname + ".vf";
-            SaveNodeAnim (nodeanim, filename);
+            if (resampled) {
+                std::shared_ptr<Scene> self (shared_from_this ());
+                writer.Submit ([self, resampled, channel, filename] () {
+                    SaveResampledAnim ((*resampled)[channel], self->outputdir, filename, self->options,
+                                       self->manifest.get ());
+                });
+                continue;
+            }
+            auto node = nodemap.find (nodename);
+            const Node *restnode = node != nodemap.end () ? node->second : nullptr;
+            const double tickspersecond = anim->mTicksPerSecond;
+            std::shared_ptr<Scene> self (shared_from_this ());
+            writer.Submit ([self, nodeanim, restnode, tickspersecond, filename, totals] () {
+                const unsigned int kept = SaveNodeAnim (nodeanim, restnode, tickspersecond, self->outputdir, filename,
+                                                        self->options, self->manifest.get ());
+                if (totals) {
+                    totals->Add (nodeanim->mNumPositionKeys + nodeanim->mNumScalingKeys
+                                 + nodeanim->mNumRotationKeys, kept);
+                }
+            });
         }
     }
 }
@@ -24,26 +24,73 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include "Arguments.h"
 
 class Node;
+class ThreadPool;
+class Writer;
+class Manifest;
+class VF;
 
-class Scene {
+/*
+ * Writes vf to outputdir + filename, unless the manifest shows that the
+ * file on disk already has the same content.
+ */
+void SaveVF (VF &vf, const std::string &outputdir, const std::string &filename,
+             const Options &options, Manifest *manifest);
+/*
+ * Writes the keys of one animation channel; node is the animated node,
+ * if known, whose rest pose lets constant tracks be dropped. Returns the
+ * number of keys written.
+ */
+unsigned int SaveNodeAnim (aiNodeAnim *anim, const Node *node, double tickspersecond,
+                           const std::string &outputdir, const std::string &filename, const Options &options,
+                           Manifest *manifest);
+
+class Scene : public std::enable_shared_from_this<Scene> {
 public:
-    Scene (void);
+    /*
+     * Output files are written to outputdir, which is either empty or
+     * ends with a path separator. If a manifest is given, files whose
+     * content did not change since the last run are not rewritten.
+     */
+    Scene (const Options &options, const std::string &outputdir = std::string (),
+           const std::shared_ptr<Manifest> &manifest = std::shared_ptr<Manifest> ());
     ~Scene (void);
-    void Load (const aiScene *scene);
-    void Save (void);
+    /*
+     * If a writer is given, every node is queued for writing as soon as
+     * it has been converted. Write jobs hold a reference to the Scene,
+     * which therefore has to be owned by a std::shared_ptr.
+     * Load consumes the aiScene: meshes are freed as soon as all nodes
+     * using them are converted, the animations are taken over and the
+     * material names copied, and the reference to the aiScene is dropped
+     * on return, so that it can be freed before anything is saved.
+     * With options.streaming the output of every node is freed as soon as
+     * it is written, or right after conversion if there is no writer.
+     */
+    void Load (const std::shared_ptr<aiScene> &scene, ThreadPool &pool, Writer *writer = nullptr);
+    void Save (Writer &writer);
     void ListOutputs (void);
     void ListMaterials (void);
     void ListNodes (void);
     void ListAnimationData (void);
     const aiScene *GetScene (void) const {
-        return scene;
+        return scene.get ();
+    }
+    const Options &GetOptions (void) const {
+        return options;
     }
 private:
+    const Options options;
+    const std::string outputdir;
+    const std::shared_ptr<Manifest> manifest;
     std::map<std::string, Node*> nodemap;
     std::vector<std::unique_ptr<Node>> nodelist;
-    const aiScene *scene;
+    std::shared_ptr<aiScene> scene;
+    /* without the "Material-" prefix */
+    std::vector<std::string> materialnames;
+    std::vector<std::unique_ptr<aiAnimation>> animations;
+    bool nodeswritten;
 };
 
 #endif /* !defined ASSIMP2VF_SCENE_H */
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Simplify.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/* Symmetric 4x4 matrix (upper triangle) and the total area it was accumulated from. */
+struct Quadric {
+    Quadric (void) : a { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, weight (0) {
+    }
+    void AddPlane (const double n[3], double d, double w) {
+        a[0] += w * n[0] * n[0]; a[1] += w * n[0] * n[1]; a[2] += w * n[0] * n[2]; a[3] += w * n[0] * d;
+        a[4] += w * n[1] * n[1]; a[5] += w * n[1] * n[2]; a[6] += w * n[1] * d;
+        a[7] += w * n[2] * n[2]; a[8] += w * n[2] * d;
+        a[9] += w * d * d;
+        weight += w;
+    }
+    void Add (const Quadric &q) {
+        for (auto i = 0; i < 10; i++) a[i] += q.a[i];
+        weight += q.weight;
+    }
+    /* mean squared distance of p from the planes */
+    double Evaluate (const float *p) const {
+        if (weight <= 0) return 0;
+        const double x = p[0], y = p[1], z = p[2];
+        const double e = a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x
+                       + a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y
+                       + a[7] * z * z + 2 * a[8] * z + a[9];
+        return std::max (0.0, e / weight);
+    }
+    double a[10];
+    double weight;
+};
+
+void Normal (const float *a, const float *b, const float *c, double n[3]) {
+    const double u[3] = { double (b[0]) - a[0], double (b[1]) - a[1], double (b[2]) - a[2] };
+    const double v[3] = { double (c[0]) - a[0], double (c[1]) - a[1], double (c[2]) - a[2] };
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+struct Collapse {
+    double cost;
+    uint32_t from;
+    uint32_t to;
+    bool operator< (const Collapse &rhs) const {
+        return cost < rhs.cost;
+    }
+};
+
+}
+
+std::vector<uint32_t> SimplifyMesh (const std::vector<uint32_t> &indices, const float *positions, size_t numvertices,
+                                    const uint8_t *locked, size_t targettriangles, float maxerror, float &error) {
+    auto position = [&] (uint32_t v) -> const float* {
+        return positions + size_t (v) * 3;
+    };
+    const double costlimit = double (maxerror) * maxerror;
+    double maxcost = 0;
+    std::vector<uint32_t> result (indices);
+
+    std::vector<Quadric> quadrics (numvertices);
+    for (size_t t = 0; t + 2 < result.size (); t += 3) {
+        double n[3];
+        Normal (position (result[t]), position (result[t + 1]), position (result[t + 2]), n);
+        const double length = std::sqrt (n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0) continue;
+        for (auto &c : n) c /= length;
+        const float *p = position (result[t]);
+        const double d = -(n[0] * p[0] + n[1] * p[1] + n[2] * p[2]);
+        for (auto i = 0; i < 3; i++) {
+            quadrics[result[t + i]].AddPlane (n, d, length * 0.5);
+        }
+    }
+
+    std::vector<uint32_t> offsets (numvertices + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> touched (numvertices);
+    std::vector<uint32_t> remap (numvertices);
+
+    while (result.size () / 3 > targettriangles) {
+        /* vertex to triangle adjacency of the current list */
+        std::fill (offsets.begin (), offsets.end (), 0);
+        for (auto v : result) offsets[v + 1]++;
+        for (size_t v = 0; v < numvertices; v++) offsets[v + 1] += offsets[v];
+        adjacency.resize (result.size ());
+        {
+            std::vector<uint32_t> fill (offsets.begin (), offsets.end () - 1);
+            for (size_t i = 0; i < result.size (); i++) adjacency[fill[result[i]]++] = i / 3;
+        }
+
+        collapses.clear ();
+        for (size_t t = 0; t < result.size (); t += 3) {
+            for (auto i = 0; i < 3; i++) {
+                const uint32_t a = result[t + i], b = result[t + (i + 1) % 3];
+                if (!locked[a]) collapses.push_back ({ quadrics[a].Evaluate (position (b)), a, b });
+                if (!locked[b]) collapses.push_back ({ quadrics[b].Evaluate (position (a)), b, a });
+            }
+        }
+        std::sort (collapses.begin (), collapses.end ());
+
+        std::fill (touched.begin (), touched.end (), 0);
+        for (size_t v = 0; v < numvertices; v++) remap[v] = v;
+        /* each collapse of an interior edge removes two triangles */
+        size_t removable = (result.size () / 3 - targettriangles + 1) / 2;
+        size_t performed = 0;
+        for (auto &collapse : collapses) {
+            if (performed >= removable || collapse.cost > costlimit) break;
+            const uint32_t from = collapse.from, to = collapse.to;
+            if (touched[from] || touched[to]) continue;
+
+            /* reject collapses that flip or degenerate a remaining triangle */
+            bool valid = true;
+            for (auto i = offsets[from]; i < offsets[from + 1] && valid; i++) {
+                const uint32_t *triangle = &result[adjacency[i] * 3];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+                const float *corners[3], *moved[3];
+                for (auto j = 0; j < 3; j++) {
+                    corners[j] = position (triangle[j]);
+                    moved[j] = triangle[j] == from ? position (to) : corners[j];
+                }
+                double before[3], after[3];
+                Normal (corners[0], corners[1], corners[2], before);
+                Normal (moved[0], moved[1], moved[2], after);
+                const double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+                const double lengths = std::sqrt ((before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+                                                  * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+                if (!(dot > 0.25 * lengths)) valid = false;
+            }
+            if (!valid) continue;
+
+            /* the triangles around from change, so their vertices wait for the next pass */
+            for (auto i = offsets[from]; i < offsets[from + 1]; i++) {
+                const uint32_t *triangle = &result[adjacency[i] * 3];
+                for (auto j = 0; j < 3; j++) touched[triangle[j]] = 1;
+            }
+            remap[from] = to;
+            quadrics[to].Add (quadrics[from]);
+            maxcost = std::max (maxcost, collapse.cost);
+            performed++;
+        }
+        if (performed == 0) break;
+
+        size_t out = 0;
+        for (size_t t = 0; t < result.size (); t += 3) {
+            const uint32_t a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+            if (a == b || b == c || c == a) continue;
+            result[out++] = a;
+            result[out++] = b;
+            result[out++] = c;
+        }
+        result.resize (out);
+    }
+
+    error = std::sqrt (maxcost);
+    return result;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_SIMPLIFY_H
+#define ASSIMP2VF_SIMPLIFY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Reduces a triangle list to about targettriangles triangles by collapsing
+ * edges onto one of their end points (Garland and Heckbert quadrics), so
+ * the result indexes the same vertex buffer. Vertices with locked[v] set
+ * are never removed. Positions are given as consecutive x, y, z triples.
+ * Collapses with an error above maxerror are not performed, so the target
+ * may not be reached. The largest collapse error is returned in error, as
+ * an area weighted root mean square distance from the removed vertices'
+ * original planes.
+ */
+std::vector<uint32_t> SimplifyMesh (const std::vector<uint32_t> &indices, const float *positions, size_t numvertices,
+                                    const uint8_t *locked, size_t targettriangles, float maxerror, float &error);
+
+#endif /* !defined ASSIMP2VF_SIMPLIFY_H */
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+/* the pool the calling thread works for, if any, and its worker index in that pool */
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local unsigned int current_worker = 0;
+}
+
+ThreadPool::ThreadPool (unsigned int numthreads) : queued (0), next (0), stop (false) {
+    if (numthreads == 0) {
+        numthreads = std::max (1u, std::thread::hardware_concurrency ());
+    }
+    for (auto i = 0; i < numthreads; i++) {
+        workers.emplace_back (new Worker);
+    }
+    for (auto i = 0; i < numthreads; i++) {
+        threads.emplace_back (&ThreadPool::Run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool (void) {
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        stop = true;
+    }
+    condition.notify_all ();
+    for (auto &thread : threads) {
+        thread.join ();
+    }
+}
+
+void ThreadPool::Submit (Task task) {
+    /* a worker of another pool is an outside thread for this one */
+    unsigned int id = current_pool == this ? current_worker : next++ % workers.size ();
+    {
+        std::lock_guard<std::mutex> lock (workers[id]->mutex);
+        workers[id]->tasks.push_back (std::move (task));
+    }
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        queued++;
+    }
+    condition.notify_one ();
+}
+
+bool ThreadPool::Pop (unsigned int id, Task &task) {
+    {
+        std::lock_guard<std::mutex> lock (workers[id]->mutex);
+        if (!workers[id]->tasks.empty ()) {
+            task = std::move (workers[id]->tasks.back ());
+            workers[id]->tasks.pop_back ();
+            return true;
+        }
+    }
+    for (auto i = 1; i < workers.size (); i++) {
+        Worker &victim = *workers[(id + i) % workers.size ()];
+        std::lock_guard<std::mutex> lock (victim.mutex);
+        if (!victim.tasks.empty ()) {
+            task = std::move (victim.tasks.front ());
+            victim.tasks.pop_front ();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run (unsigned int id) {
+    current_pool = this;
+    current_worker = id;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            condition.wait (lock, [this] () { return stop || queued > 0; });
+            if (queued == 0) return;
+            queued--;
+        }
+        Task task;
+        while (!Pop (id, task)) {
+            std::this_thread::yield ();
+        }
+        task ();
+    }
+}
+
+TaskGroup::TaskGroup (ThreadPool &pool_) : pool (pool_), pending (0) {
+}
+
+TaskGroup::~TaskGroup (void) {
+    std::unique_lock<std::mutex> lock (mutex);
+    condition.wait (lock, [this] () { return pending == 0; });
+}
+
+void TaskGroup::Submit (ThreadPool::Task task) {
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        pending++;
+    }
+    pool.Submit ([this, task] () {
+        std::exception_ptr e;
+        try {
+            task ();
+        } catch (...) {
+            e = std::current_exception ();
+        }
+        std::lock_guard<std::mutex> lock (mutex);
+        if (e && !error) error = e;
+        if (--pending == 0) condition.notify_all ();
+    });
+}
+
+void TaskGroup::Wait (void) {
+    std::unique_lock<std::mutex> lock (mutex);
+    condition.wait (lock, [this] () { return pending == 0; });
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception (e);
+    }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_THREADPOOL_H
+#define ASSIMP2VF_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Work stealing thread pool: every worker owns a deque, runs its own tasks
+ * in LIFO order and steals the oldest task of another worker when idle.
+ */
+class ThreadPool {
+public:
+    typedef std::function<void(void)> Task;
+    ThreadPool (unsigned int numthreads = 0);
+    ThreadPool (const ThreadPool&) = delete;
+    ~ThreadPool (void);
+    ThreadPool &operator= (const ThreadPool&) = delete;
+    void Submit (Task task);
+    unsigned int GetNumThreads (void) const {
+        return threads.size ();
+    }
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    void Run (unsigned int id);
+    bool Pop (unsigned int id, Task &task);
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<unsigned int> queued;
+    std::atomic<unsigned int> next;
+    bool stop;
+};
+
+/*
+ * A set of tasks submitted to a pool that can be waited for as a whole.
+ * Wait () rethrows the first exception thrown by any of the tasks and must
+ * not be called from within a task of the same pool.
+ */
+class TaskGroup {
+public:
+    TaskGroup (ThreadPool &pool);
+    TaskGroup (const TaskGroup&) = delete;
+    ~TaskGroup (void);
+    TaskGroup &operator= (const TaskGroup&) = delete;
+    void Submit (ThreadPool::Task task);
+    void Wait (void);
+private:
+    ThreadPool &pool;
+    std::mutex mutex;
+    std::condition_variable condition;
+    unsigned int pending;
+    std::exception_ptr error;
+};
+
+#endif /* !defined ASSIMP2VF_THREADPOOL_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_VF_H
+#define ASSIMP2VF_VF_H
+
+#include <openvf/openvf.h>
+#include <string>
+#include "Hash.h"
+
+/*
+ * Owns a vf_t and hashes every set that is added to it, so that unchanged
+ * outputs can be recognized without serializing them. The vf_t is only
+ * allocated when the first set is added.
+ */
+class VF {
+public:
+    VF (void) : vf (nullptr) {
+    }
+    VF (const VF&) = delete;
+    ~VF (void) {
+        Free ();
+    }
+    VF &operator= (const VF&) = delete;
+    template<typename T, typename Type>
+    void AddSet (const std::string &name, unsigned int components, Type type, size_t count, const T *data) {
+        hash.Update (name);
+        hash.Update (components);
+        hash.Update (static_cast<int> (type));
+        hash.Update (count);
+        hash.Update (data, components * count * sizeof (T));
+        if (!vf) vf = vfAlloc ();
+        vfAddSet (vf, name.c_str (), components, type, count, data, 0);
+    }
+    bool IsEmpty (void) const {
+        return !vf || vfGetFirstSet (vf) == nullptr;
+    }
+    /* drops all sets */
+    void Free (void) {
+        if (vf) vfFree (vf);
+        vf = nullptr;
+        hash = ContentHash ();
+    }
+    uint64_t GetHash (void) const {
+        return hash.Get ();
+    }
+    operator vf_t* (void) {
+        return vf;
+    }
+    operator const vf_t* (void) const {
+        return vf;
+    }
+private:
+    vf_t *vf;
+    ContentHash hash;
+};
+
+#endif /* !defined ASSIMP2VF_VF_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_VERTEX_H
+#define ASSIMP2VF_VERTEX_H
+
+#include <assimp/scene.h>
+#include "VertexWelder.h"
+
+/*
+ * Flat vertex record: position, optional normal and NumUVChannels texture
+ * coordinate pairs. Channels or normals missing in the source mesh are
+ * zero-filled, so that meshes with differing layouts can share a buffer.
+ */
+template<unsigned int NumUVChannels, bool HasNormals>
+struct Vertex {
+    static const unsigned int NumFloats = 3 + (HasNormals ? 3 : 0) + 2 * NumUVChannels;
+    Vertex (const aiMesh *mesh, unsigned int uvchannels, unsigned int index) {
+        const aiVector3D &position = mesh->mVertices[index];
+        data[0] = position.x;
+        data[1] = position.y;
+        data[2] = position.z;
+        float *texcoords = data + 3;
+        if (HasNormals) {
+            if (mesh->mNormals) {
+                const aiVector3D &normal = mesh->mNormals[index];
+                data[3] = normal.x;
+                data[4] = normal.y;
+                data[5] = normal.z;
+            } else {
+                data[3] = data[4] = data[5] = 0.0f;
+            }
+            texcoords += 3;
+        }
+        for (auto i = 0; i < NumUVChannels; i++) {
+            if (i < uvchannels) {
+                texcoords[i * 2 + 0] = mesh->mTextureCoords[i][index].x;
+                texcoords[i * 2 + 1] = mesh->mTextureCoords[i][index].y;
+            } else {
+                texcoords[i * 2 + 0] = texcoords[i * 2 + 1] = 0.0f;
+            }
+        }
+    }
+    const float *position (void) const {
+        return data;
+    }
+    const float *normal (void) const {
+        return data + 3;
+    }
+    const float *texcoord (unsigned int channel) const {
+        return data + (HasNormals ? 6 : 3) + channel * 2;
+    }
+    float data[NumFloats];
+};
+
+template<unsigned int NumUVChannels, bool HasNormals>
+struct WeldTraits<Vertex<NumUVChannels, HasNormals>> {
+    typedef Vertex<NumUVChannels, HasNormals> vertex_type;
+    static uint32_t Hash (const vertex_type &v) {
+        WeldHash hash;
+        for (auto i = 0; i < vertex_type::NumFloats; i++) {
+            hash.Add (v.data[i]);
+        }
+        return hash.Get ();
+    }
+    static bool Equal (const vertex_type &lhs, const vertex_type &rhs) {
+        for (auto i = 0; i < vertex_type::NumFloats; i++) {
+            if (CanonicalBits (lhs.data[i]) != CanonicalBits (rhs.data[i])) return false;
+        }
+        return true;
+    }
+};
+
+#endif /* !defined ASSIMP2VF_VERTEX_H */
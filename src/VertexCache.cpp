@@ -0,0 +1,165 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VertexCache.h"
+#include <algorithm>
+
+VertexCacheStats AnalyzeVertexCache (const std::vector<uint32_t> &indices, unsigned int numvertices,
+                                     unsigned int cachesize) {
+    VertexCacheStats stats;
+    if (indices.empty ()) return stats;
+
+    /* a vertex is in the FIFO iff it was inserted less than cachesize insertions ago */
+    std::vector<uint64_t> inserted (numvertices, 0);
+    std::vector<bool> referenced (numvertices, false);
+    uint64_t time = cachesize + 1;
+    size_t misses = 0, distinct = 0;
+    for (auto index : indices) {
+        if (time - inserted[index] > cachesize) {
+            inserted[index] = time++;
+            misses++;
+        }
+        if (!referenced[index]) {
+            referenced[index] = true;
+            distinct++;
+        }
+    }
+    stats.acmr = double (misses) / (indices.size () / 3);
+    stats.atvr = double (misses) / distinct;
+    return stats;
+}
+
+void OptimizeVertexCache (std::vector<uint32_t> &indices, unsigned int numvertices, unsigned int cachesize) {
+    const size_t numtriangles = indices.size () / 3;
+    if (numtriangles == 0) return;
+
+    /* vertex-triangle adjacency in compressed form; live counts the triangles not yet emitted */
+    std::vector<uint32_t> offsets (numvertices + 1, 0);
+    for (auto index : indices) offsets[index + 1]++;
+    for (auto v = 0; v < numvertices; v++) offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> live (numvertices);
+    for (auto v = 0; v < numvertices; v++) live[v] = offsets[v + 1] - offsets[v];
+    std::vector<uint32_t> adjacency (indices.size ());
+    {
+        std::vector<uint32_t> fill (offsets.begin (), offsets.end () - 1);
+        for (size_t i = 0; i < indices.size (); i++) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<uint32_t> timestamps (numvertices, 0);
+    std::vector<bool> emitted (numtriangles, false);
+    std::vector<uint32_t> deadend;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve (indices.size ());
+    uint32_t time = cachesize + 1;
+    unsigned int cursor = 0;
+    int64_t fanning = 0;
+
+    while (fanning >= 0) {
+        candidates.clear ();
+        for (auto a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+            const uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+            for (auto i = 0; i < 3; i++) {
+                const uint32_t v = indices[t * 3 + i];
+                output.push_back (v);
+                deadend.push_back (v);
+                candidates.push_back (v);
+                live[v]--;
+                if (time - timestamps[v] > cachesize) {
+                    timestamps[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        /* prefer the candidate that stays in the cache longest while its remaining triangles are emitted */
+        fanning = -1;
+        int64_t best = -1;
+        for (auto v : candidates) {
+            if (live[v] == 0) continue;
+            int64_t priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cachesize) {
+                priority = time - timestamps[v];
+            }
+            if (priority > best) {
+                best = priority;
+                fanning = v;
+            }
+        }
+        if (fanning < 0) {
+            while (!deadend.empty ()) {
+                const uint32_t v = deadend.back ();
+                deadend.pop_back ();
+                if (live[v] > 0) {
+                    fanning = v;
+                    break;
+                }
+            }
+        }
+        if (fanning < 0) {
+            for (; cursor < numvertices; cursor++) {
+                if (live[cursor] > 0) {
+                    fanning = cursor;
+                    break;
+                }
+            }
+        }
+    }
+    indices.swap (output);
+}
+
+double AnalyzeVertexFetch (const std::vector<uint32_t> &indices, unsigned int numvertices, size_t vertexsize) {
+    enum { LineSize = 64, CacheLines = 256 };
+    const size_t numlines = (size_t (numvertices) * vertexsize + LineSize - 1) / LineSize;
+    std::vector<uint64_t> loaded (numlines, 0);
+    std::vector<bool> referenced (numvertices, false);
+    uint64_t time = CacheLines + 1;
+    size_t fetched = 0, distinct = 0;
+    for (auto index : indices) {
+        if (!referenced[index]) {
+            referenced[index] = true;
+            distinct++;
+        }
+        const size_t first = index * vertexsize / LineSize;
+        const size_t last = ((index + 1) * vertexsize - 1) / LineSize;
+        for (auto line = first; line <= last; line++) {
+            if (time - loaded[line] > CacheLines) {
+                loaded[line] = time++;
+                fetched += LineSize;
+            }
+        }
+    }
+    return distinct ? double (fetched) / (distinct * vertexsize) : 0.0;
+}
+
+std::vector<uint32_t> OptimizeVertexFetch (const std::vector<uint32_t> &indices, unsigned int numvertices) {
+    enum : uint32_t { Unused = 0xffffffffu };
+    std::vector<uint32_t> remap (numvertices, Unused);
+    uint32_t next = 0;
+    for (auto index : indices) {
+        if (remap[index] == Unused) remap[index] = next++;
+    }
+    for (auto &index : remap) {
+        if (index == Unused) index = next++;
+    }
+    return remap;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_VERTEXCACHE_H
+#define ASSIMP2VF_VERTEXCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct VertexCacheStats {
+    VertexCacheStats (void) : acmr (0), atvr (0) {
+    }
+    /* cache misses per triangle */
+    double acmr;
+    /* cache misses per distinct vertex referenced */
+    double atvr;
+};
+
+/*
+ * Simulates a FIFO post-transform cache of the given size on a triangle
+ * list whose indices are smaller than numvertices.
+ */
+VertexCacheStats AnalyzeVertexCache (const std::vector<uint32_t> &indices, unsigned int numvertices,
+                                     unsigned int cachesize);
+
+/*
+ * Reorders the triangles of the list in place for a cache of the given
+ * size (Tipsify, Sander et al. 2007). Runs in time linear in the number of
+ * indices and vertices.
+ */
+void OptimizeVertexCache (std::vector<uint32_t> &indices, unsigned int numvertices, unsigned int cachesize);
+
+/*
+ * Bytes of vertex data loaded per byte of vertices referenced, when the
+ * vertices are fetched in index order from an array with the given vertex
+ * size through a small cache of 64 byte lines. 1 is optimal.
+ */
+double AnalyzeVertexFetch (const std::vector<uint32_t> &indices, unsigned int numvertices, size_t vertexsize);
+
+/*
+ * Returns the permutation (old index to new index) that numbers the
+ * vertices in order of their first use in indices. Vertices that are not
+ * referenced keep their relative order after the referenced ones.
+ */
+std::vector<uint32_t> OptimizeVertexFetch (const std::vector<uint32_t> &indices, unsigned int numvertices);
+
+#endif /* !defined ASSIMP2VF_VERTEXCACHE_H */
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_VERTEXWELDER_H
+#define ASSIMP2VF_VERTEXWELDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+ * Bit pattern used to hash and compare vertex attributes:
+ * -0.0 is folded onto 0.0 and every NaN onto a single quiet NaN,
+ * so that equality is an equivalence relation on all inputs.
+ */
+inline uint32_t CanonicalBits (float f) {
+    if (f == 0.0f) return 0;
+    if (f != f) return 0x7fc00000u;
+    uint32_t bits;
+    std::memcpy (&bits, &f, sizeof (bits));
+    return bits;
+}
+
+class WeldHash {
+public:
+    WeldHash (void) : h (0x9e3779b97f4a7c15ull) {
+    }
+    void Add (float f) {
+        h = (h ^ CanonicalBits (f)) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+    }
+    uint32_t Get (void) const {
+        uint64_t x = h;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return static_cast<uint32_t> (x);
+    }
+private:
+    uint64_t h;
+};
+
+/*
+ * WeldTraits<Vertex> has to provide
+ *   static uint32_t Hash (const Vertex&);
+ *   static bool Equal (const Vertex&, const Vertex&);
+ * both based on CanonicalBits.
+ */
+template<typename Vertex>
+struct WeldTraits;
+
+/*
+ * Open addressing (linear probing) hash table that assigns each distinct
+ * vertex the index of its first occurrence.
+ */
+template<typename Vertex, typename Traits = WeldTraits<Vertex>>
+class VertexWelder {
+public:
+    VertexWelder (size_t expected = 0) : count (0) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) capacity <<= 1;
+        slots.resize (capacity, Empty);
+        hashes.resize (capacity);
+        mask = capacity - 1;
+        vertices.reserve (expected);
+    }
+    unsigned int Weld (const Vertex &v) {
+        uint32_t hash = Traits::Hash (v);
+        size_t slot = hash & mask;
+        while (slots[slot] != Empty) {
+            if (hashes[slot] == hash && Traits::Equal (vertices[slots[slot]], v)) {
+                return slots[slot];
+            }
+            slot = (slot + 1) & mask;
+        }
+        unsigned int index = vertices.size ();
+        vertices.push_back (v);
+        slots[slot] = index;
+        hashes[slot] = hash;
+        if (++count * 2 > slots.size ()) Grow ();
+        return index;
+    }
+    const std::vector<Vertex> &GetVertices (void) const {
+        return vertices;
+    }
+    /*
+     * Appends the welded vertices to output and empties the welder, so that
+     * subsequent vertices are numbered from 0 again.
+     */
+    void Flush (std::vector<Vertex> &output) {
+        if (output.empty ()) {
+            output.swap (vertices);
+        } else {
+            output.insert (output.end (), vertices.begin (), vertices.end ());
+        }
+        vertices.clear ();
+        std::fill (slots.begin (), slots.end (), Empty);
+        count = 0;
+    }
+private:
+    enum : uint32_t { Empty = 0xffffffffu };
+    void Grow (void) {
+        std::vector<uint32_t> oldslots (slots.size () * 2, Empty);
+        std::vector<uint32_t> oldhashes (hashes.size () * 2);
+        oldslots.swap (slots);
+        oldhashes.swap (hashes);
+        mask = slots.size () - 1;
+        for (size_t i = 0; i < oldslots.size (); i++) {
+            if (oldslots[i] == Empty) continue;
+            size_t slot = oldhashes[i] & mask;
+            while (slots[slot] != Empty) slot = (slot + 1) & mask;
+            slots[slot] = oldslots[i];
+            hashes[slot] = oldhashes[i];
+        }
+    }
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> slots;
+    std::vector<uint32_t> hashes;
+    size_t mask;
+    size_t count;
+};
+
+#endif /* !defined ASSIMP2VF_VERTEXWELDER_H */
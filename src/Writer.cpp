@@ -0,0 +1,84 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Writer.h"
+#include <algorithm>
+
+Writer::Writer (unsigned int numthreads, size_t capacity_) : capacity (std::max<size_t> (capacity_, 1)), finished (false) {
+    numthreads = std::max (numthreads, 1u);
+    for (auto i = 0; i < numthreads; i++) {
+        threads.emplace_back (&Writer::Run, this);
+    }
+}
+
+Writer::~Writer (void) {
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        jobs.clear ();
+    }
+    Join ();
+}
+
+void Writer::Submit (Job job) {
+    std::unique_lock<std::mutex> lock (mutex);
+    notfull.wait (lock, [this] () { return jobs.size () < capacity || error; });
+    if (error) return;
+    jobs.push_back (std::move (job));
+    notempty.notify_one ();
+}
+
+void Writer::Finish (void) {
+    Join ();
+    if (error) {
+        std::rethrow_exception (error);
+    }
+}
+
+void Writer::Join (void) {
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        finished = true;
+    }
+    notempty.notify_all ();
+    for (auto &thread : threads) {
+        if (thread.joinable ()) thread.join ();
+    }
+}
+
+void Writer::Run (void) {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            notempty.wait (lock, [this] () { return finished || !jobs.empty (); });
+            if (jobs.empty ()) return;
+            job = std::move (jobs.front ());
+            jobs.pop_front ();
+        }
+        notfull.notify_one ();
+        try {
+            job ();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!error) error = std::current_exception ();
+            jobs.clear ();
+            notfull.notify_all ();
+        }
+    }
+}
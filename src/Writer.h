@@ -0,0 +1,58 @@
+/*
+ * Copyright 2016 Daniel Kirchner
+ *
+ * This file is part of assimp2vf.
+ *
+ * assimp2vf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * assimp2vf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSIMP2VF_WRITER_H
+#define ASSIMP2VF_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Output stage: a bounded queue of write jobs drained by a fixed number of
+ * threads. Submit () blocks while the queue is full, which throttles the
+ * producers to the speed of the file system.
+ */
+class Writer {
+public:
+    typedef std::function<void(void)> Job;
+    Writer (unsigned int numthreads, size_t capacity);
+    Writer (const Writer&) = delete;
+    ~Writer (void);
+    Writer &operator= (const Writer&) = delete;
+    void Submit (Job job);
+    void Finish (void);
+private:
+    void Run (void);
+    void Join (void);
+    std::vector<std::thread> threads;
+    std::deque<Job> jobs;
+    const size_t capacity;
+    std::mutex mutex;
+    std::condition_variable notempty;
+    std::condition_variable notfull;
+    bool finished;
+    std::exception_ptr error;
+};
+
+#endif /* !defined ASSIMP2VF_WRITER_H */
@@ -17,59 +17,165 @@
  * along with assimp2vf.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
 #include <iostream>
-#include <assimp/Importer.hpp>
+#include <set>
+#include <cerrno>
+#include <sys/stat.h>
 #include <assimp/DefaultLogger.hpp>
-#include <assimp/postprocess.h>
 #include "Scene.h"
 #include "Arguments.h"
+#include "Import.h"
+#include "Profiler.h"
+#include "Manifest.h"
+#include "ThreadPool.h"
+#include "Writer.h"
+
+namespace {
+
+/*
+ * A single input is written to the output directory itself (by default the
+ * working directory), several inputs to one subdirectory per input that is
+ * named after the input file.
+ */
+std::vector<std::string> OutputDirectories (const std::vector<std::string> &inputfiles, const std::string &outputdir) {
+    std::vector<std::string> outputdirs;
+    std::string prefix = outputdir;
+    if (!prefix.empty () && prefix.back () != '/') prefix += '/';
+    if (inputfiles.size () == 1) {
+        outputdirs.push_back (prefix);
+        return outputdirs;
+    }
+    if (prefix.empty ()) prefix = "./";
+    std::set<std::string> used;
+    for (auto &inputfile : inputfiles) {
+        std::string stem = inputfile.substr (inputfile.find_last_of ('/') + 1);
+        stem = stem.substr (0, stem.find_last_of ('.'));
+        if (stem.empty ()) stem = "unnamed";
+        if (!used.insert (stem).second) {
+            throw std::runtime_error ("more than one input file named \"" + stem + "\"");
+        }
+        outputdirs.push_back (prefix + stem + "/");
+    }
+    return outputdirs;
+}
+
+void MakeDirectory (const std::string &path) {
+    for (auto pos = path.find ('/', 1); pos != std::string::npos; pos = path.find ('/', pos + 1)) {
+        std::string dir = path.substr (0, pos);
+        if (mkdir (dir.c_str (), 0777) != 0 && errno != EEXIST) {
+            throw std::runtime_error ("cannot create directory \"" + dir + "\"");
+        }
+    }
+}
+
+struct Input {
+    std::shared_ptr<aiScene> scene;
+    std::string error;
+};
+
+}
 
 int main (int argc, char *argv[]) {
     try {
-        Assimp::Importer importer;
-#ifdef AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES
-        importer.SetPropertyBool(AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES, true);
-#else
-# warning "AI_CONFIG_IMPORT_COLLADA_USE_COLLADA_NAMES not supported by assimp! Falling back to using id tags as names instead."
-#endif
         Assimp::DefaultLogger::create ("", Assimp::Logger::VERBOSE);
 
         if (!arguments ().parse (argc, argv))
             return EXIT_SUCCESS;
+        if (arguments ().profile () != Arguments::PROFILE_NONE) {
+            Profiler::get ().Enable ();
+        }
+
+        const std::vector<std::string> &inputfiles = arguments ().inputfiles ();
+        const std::vector<std::string> outputdirs = OutputDirectories (inputfiles, arguments ().outputdir ());
+        const Options &options = arguments ().options ();
+        const bool convert = arguments ().action () == Arguments::CONVERT;
+        int status = EXIT_SUCCESS;
+
+        ThreadPool pool (arguments ().threads ());
+        Writer writer (arguments ().writers (), 2 * arguments ().writers ());
+
+        std::vector<std::shared_ptr<Manifest>> manifests (inputfiles.size ());
+
+        // the next input is imported on the pool while the current one is converted and written
+        Input current, next;
+        std::unique_ptr<TaskGroup> prefetch;
+        current.scene = Import (inputfiles[0], options, current.error);
+
+        for (auto i = 0; i < inputfiles.size (); i++) {
+            if (i > 0) {
+                prefetch->Wait ();
+                current = std::move (next);
+                next = Input ();
+            }
+            if (i + 1 < inputfiles.size ()) {
+                prefetch.reset (new TaskGroup (pool));
+                const std::string &inputfile = inputfiles[i + 1];
+                prefetch->Submit ([&next, &inputfile, &options] () {
+                    next.scene = Import (inputfile, options, next.error);
+                });
+            }
+
+            if (!current.scene) {
+                std::cerr << "Cannot load " << inputfiles[i] << ": " << current.error << std::endl;
+                status = EXIT_FAILURE;
+                continue;
+            }
+
+            if (convert) {
+                MakeDirectory (outputdirs[i]);
+                if (arguments ().incremental ()) {
+                    manifests[i] = std::make_shared<Manifest> (outputdirs[i]);
+                }
+            }
+            std::shared_ptr<Scene> scene (std::make_shared<Scene> (options, outputdirs[i], manifests[i]));
+            scene->Load (current.scene, pool, convert ? &writer : nullptr);
+            current = Input ();
+
+            switch (arguments().action ()) {
+                case Arguments::CONVERT:
+                    scene->Save (writer);
+                    break;
+                case Arguments::LIST_OUTPUTS:
+                    scene->ListOutputs ();
+                    break;
+                case Arguments::LIST_MATERIALS:
+                    scene->ListMaterials ();
+                    break;
+                case Arguments::LIST_NODES:
+                    scene->ListNodes ();
+                    break;
+                case Arguments::LIST_ANIMATIONDATA:
+                    scene->ListAnimationData ();
+                    break;
+                default:
+                    throw std::runtime_error ("invalid action");
+            }
+        }
+        writer.Finish ();
 
-        const aiScene *aiscene = importer.ReadFile (arguments ().inputfile (), aiProcess_GenSmoothNormals|aiProcess_CalcTangentSpace
-                                                             |aiProcess_Triangulate|aiProcess_GenUVCoords|aiProcess_OptimizeMeshes
-                                                             |aiProcess_SortByPType|aiProcess_FindDegenerates|aiProcess_ImproveCacheLocality
-                                                             |(arguments ().flipUV() ? aiProcess_FlipUVs : 0));
-        if (!aiscene) {
-            std::cerr << "Cannot load " << arguments ().inputfile () << ": " << importer.GetErrorString () << std::endl;
-            return EXIT_FAILURE;
+        for (auto i = 0; i < manifests.size (); i++) {
+            if (!manifests[i]) continue;
+            manifests[i]->Save ();
+            std::cerr << inputfiles[i] << ": " << manifests[i]->GetNumSkipped () << " of "
+                      << manifests[i]->GetNumSkipped () + manifests[i]->GetNumWritten ()
+                      << " output files unchanged, not rewritten" << std::endl;
         }
 
-        Scene scene;
-        scene.Load (aiscene);
-
-        switch (arguments().action ()) {
-            case Arguments::CONVERT:
-                scene.Save ();
-                break;
-            case Arguments::LIST_OUTPUTS:
-                scene.ListOutputs ();
-                break;
-            case Arguments::LIST_MATERIALS:
-                scene.ListMaterials ();
-                break;
-            case Arguments::LIST_NODES:
-                scene.ListNodes ();
-                break;
-            case Arguments::LIST_ANIMATIONDATA:
-                scene.ListAnimationData ();
-                break;
-            default:
-                throw std::runtime_error ("invalid action");
+        if (arguments ().profile () != Arguments::PROFILE_NONE) {
+            const bool json = arguments ().profile () == Arguments::PROFILE_JSON;
+            if (arguments ().profilefile ().empty ()) {
+                Profiler::get ().Report (std::cerr, json);
+            } else {
+                std::ofstream file (arguments ().profilefile ());
+                Profiler::get ().Report (file, json);
+                if (!file) {
+                    throw std::runtime_error ("cannot write profile to \"" + arguments ().profilefile () + "\"");
+                }
+            }
         }
 
-        return EXIT_SUCCESS;
+        return status;
     } catch (const std::exception &e) {
         std::cerr << "Exception: " << e.what () << std::endl;
         return EXIT_FAILURE;